@@ -1,5 +1,6 @@
-QT       += core gui widgets printsupport
+QT       += core gui widgets printsupport concurrent opengl
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+greaterThan(QT_MAJOR_VERSION, 5): QT += openglwidgets
 
 TARGET = LidarVis
 TEMPLATE = app
@@ -10,11 +11,32 @@ QMAKE_CXXFLAGS += -Wa,-mbig-obj
 
 CONFIG += c++17
 
+# QCustomPlot 的 OpenGL 绘图缓冲 (QCP_OPENGL_FBO)，默认关闭：qmake CONFIG+=qcp_opengl
+# 打开后仍可在界面上切回软件光栅，建立上下文失败时自动退回
+qcp_opengl: DEFINES += QCUSTOMPLOT_USE_OPENGL
+
 SOURCES += \
     main.cpp \
     mainwindow.cpp \
     datamanager.cpp \
     ppiwidget.cpp \
+    ppiglview.cpp \
+    ppirenderer.cpp \
+    colormap.cpp \
+    renderstats.cpp \
+    ppiexporter.cpp \
+    gifencoder.cpp \
+    playbackengine.cpp \
+    ppimultiview.cpp \
+    timerangeview.cpp \
+    rhiwidget.cpp \
+    gateseriesview.cpp \
+    profileoverlay.cpp \
+    compactscan.cpp \
+    processingpipeline.cpp \
+    spatialindex.cpp \
+    timepyramid.cpp \
+    vadretrieval.cpp \
     qcustomplot.cpp
 
 HEADERS += \
@@ -22,6 +44,23 @@ HEADERS += \
     datamanager.h \
     datatypes.h \
     ppiwidget.h \
+    ppiglview.h \
+    ppirenderer.h \
+    colormap.h \
+    renderstats.h \
+    ppiexporter.h \
+    gifencoder.h \
+    playbackengine.h \
+    ppimultiview.h \
+    timerangeview.h \
+    rhiwidget.h \
+    gateseriesview.h \
+    profileoverlay.h \
+    compactscan.h \
+    processingpipeline.h \
+    spatialindex.h \
+    timepyramid.h \
+    vadretrieval.h \
     qcustomplot.h
 
 win32:DEFINES += _USE_MATH_DEFINES
@@ -0,0 +1,82 @@
+#include "colormap.h"
+#include <QColor>
+#include <atomic>
+
+static std::atomic<quint64> s_nextSerial{1};
+
+QStringList ColorMap::paletteNames() {
+    return { "经典", "Jet", "Viridis", "红蓝", "灰度" };
+}
+
+void ColorMap::defaultRange(DisplayMode mode, double &lo, double &hi) {
+    if (mode == Mode_Turbulence) { lo = 0.0; hi = 0.5; }
+    else { lo = -10.0; hi = 10.0; }
+}
+
+// 分段线性插值的控制点
+struct ColorStop { double t; int r, g, b; };
+
+static QRgb interpolate(const ColorStop *stops, int count, double t) {
+    int k = 1;
+    while (k < count - 1 && t > stops[k].t) ++k;
+    const ColorStop &a = stops[k - 1], &b = stops[k];
+    double f = (b.t > a.t) ? qBound(0.0, (t - a.t) / (b.t - a.t), 1.0) : 0.0;
+    return qRgba(qRound(a.r + (b.r - a.r) * f), qRound(a.g + (b.g - a.g) * f), qRound(a.b + (b.b - a.b) * f),
+                 ColorMap::Alpha);
+}
+
+static const ColorStop kJet[] = {
+    {0.0, 0, 0, 143}, {0.125, 0, 0, 255}, {0.375, 0, 255, 255}, {0.625, 255, 255, 0}, {0.875, 255, 0, 0}, {1.0, 128, 0, 0}
+};
+static const ColorStop kViridis[] = {
+    {0.0, 68, 1, 84}, {0.25, 59, 82, 139}, {0.5, 33, 145, 140}, {0.75, 94, 201, 98}, {1.0, 253, 231, 37}
+};
+static const ColorStop kRedBlue[] = {
+    {0.0, 5, 48, 97}, {0.25, 67, 147, 195}, {0.5, 247, 247, 247}, {0.75, 214, 96, 77}, {1.0, 103, 0, 31}
+};
+static const ColorStop kGray[] = {
+    {0.0, 230, 230, 230}, {1.0, 20, 20, 20}
+};
+
+static ColorMap makeDefault(DisplayMode mode) {
+    double lo, hi;
+    ColorMap::defaultRange(mode, lo, hi);
+    return ColorMap(ColorMap::Palette_Classic, lo, hi, mode);
+}
+
+ColorMap::ColorMap() : ColorMap(Mode_Speed) {}
+
+// 默认色标每个模式只建一次，之后都是拷贝：表隐式共享，序号也相同，
+// 随手构造的 PPIView / 导出选项不再各建一张 1024 级的表，下游缓存也不会因此失效
+ColorMap::ColorMap(DisplayMode mode) {
+    static const ColorMap speed = makeDefault(Mode_Speed);
+    static const ColorMap turb = makeDefault(Mode_Turbulence);
+    *this = (mode == Mode_Turbulence) ? turb : speed;
+}
+
+ColorMap::ColorMap(Palette palette, double lo, double hi, DisplayMode mode)
+    : m_palette(palette), m_lo(lo), m_hi(hi > lo ? hi : lo + 1e-6) {
+    m_scale = (Size - 1) / (m_hi - m_lo);
+    m_serial = s_nextSerial++;
+    m_rgb.resize(Size);
+    m_premul.resize(Size);
+
+    for (int i = 0; i < Size; ++i) {
+        double t = double(i) / (Size - 1);
+        QRgb c;
+        switch (palette) {
+        case Palette_Jet:     c = interpolate(kJet, 6, t); break;
+        case Palette_Viridis: c = interpolate(kViridis, 5, t); break;
+        case Palette_RedBlue: c = interpolate(kRedBlue, 5, t); break;
+        case Palette_Gray:    c = interpolate(kGray, 2, t); break;
+        default: {
+            // 经典色环：风速 240->0 (蓝->红)，湍流 120->0 (绿->红)
+            int hueSpan = (mode == Mode_Turbulence) ? 120 : 240;
+            c = QColor::fromHsv(int(hueSpan * (1.0 - t)), 255, 255, Alpha).rgba();
+            break;
+        }
+        }
+        m_rgb[i] = c;
+        m_premul[i] = qPremultiply(c);
+    }
+}
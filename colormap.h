@@ -0,0 +1,56 @@
+#ifndef COLORMAP_H
+#define COLORMAP_H
+
+#include "datatypes.h"
+#include <QRgb>
+#include <QVector>
+#include <QStringList>
+
+// 预先算好的色标查找表：值域 [lo, hi] 量化为 Size 级，取色只是一次乘法加一次查表。
+// 表只在色标/值域/模式变化时重建；QVector 隐式共享，随 PPIView 按值传给工作线程也很便宜。
+class ColorMap
+{
+public:
+    enum Palette {
+        Palette_Classic,  // 原来的 HSV 色环：风速 蓝->红，湍流 绿->红
+        Palette_Jet,
+        Palette_Viridis,
+        Palette_RedBlue,  // 发散色标，适合正负对称的径向风速
+        Palette_Gray
+    };
+    static constexpr int Size = 1024;
+    static constexpr int Alpha = 220; // 与原先的半透明效果一致
+
+    static QStringList paletteNames();
+    static void defaultRange(DisplayMode mode, double& lo, double& hi);
+
+    ColorMap(); // 经典色标，风速 ±10 m/s
+    explicit ColorMap(DisplayMode mode); // 该模式的默认色标（经典色环 + 默认值域），全程共用一张表
+    ColorMap(Palette palette, double lo, double hi, DisplayMode mode);
+
+    QRgb color(double val) const { return m_rgb[indexOf(val)]; }          // 非预乘，给 QPainter/纹理
+    QRgb premultiplied(double val) const { return m_premul[indexOf(val)]; } // 预乘，直接写 ARGB32_Premultiplied
+    const QVector<QRgb>& table() const { return m_rgb; }
+
+    Palette palette() const { return m_palette; }
+    double lo() const { return m_lo; }
+    double hi() const { return m_hi; }
+    // 每次构建都不同，用于判断下游缓存是否过期
+    quint64 serial() const { return m_serial; }
+
+private:
+    int indexOf(double val) const {
+        double t = (val - m_lo) * m_scale + 0.5;
+        if (!(t > 0)) return 0; // 同时挡住 NaN
+        return t >= Size - 1 ? Size - 1 : int(t);
+    }
+
+    Palette m_palette = Palette_Classic;
+    double m_lo = -10.0, m_hi = 10.0;
+    double m_scale = 0.0;
+    QVector<QRgb> m_rgb;
+    QVector<QRgb> m_premul;
+    quint64 m_serial = 0;
+};
+
+#endif // COLORMAP_H
@@ -0,0 +1,112 @@
+#include "compactscan.h"
+#include <QtMath>
+#include <cmath>
+#include <limits>
+
+static qint16 quantize(double v, double scale) {
+    double q = std::round(v / scale);
+    q = qBound(double(std::numeric_limits<qint16>::min()), q, double(std::numeric_limits<qint16>::max()));
+    return qint16(q);
+}
+
+CompactScanData CompactScanData::fromScan(const ScanData &data) {
+    CompactScanData c;
+    c.reserve(data.size(), data.isEmpty() ? 0 : data.first().gates.size());
+    for (const auto &r : data) c.append(r);
+    return c;
+}
+
+ScanData CompactScanData::toScan() const {
+    ScanData out;
+    out.reserve(size());
+    for (int i = 0; i < size(); ++i) out << ray(i);
+    return out;
+}
+
+void CompactScanData::clear() {
+    *this = CompactScanData();
+}
+
+void CompactScanData::reserve(int rays, int gatesPerRay) {
+    m_tableIndex.reserve(rays);
+    m_timeMs.reserve(rays);
+    m_azimuth.reserve(rays);
+    m_elevation.reserve(rays);
+    m_gateOffset.reserve(rays + 1);
+    m_speed.reserve(qint64(rays) * gatesPerRay);
+    m_snr.reserve(qint64(rays) * gatesPerRay);
+    m_valid.reserve(qint64(rays) * gatesPerRay);
+}
+
+// 找到与该射线距离门一致的表（一般就是上一条射线用的那张），找不到才新建
+int CompactScanData::distanceTableFor(const RadarRay &ray) {
+    auto matches = [&](const QVector<float> &table) {
+        if (table.size() != ray.gates.size()) return false;
+        for (int j = 0; j < table.size(); ++j) {
+            if (table[j] != ray.gates[j].distance) return false;
+        }
+        return true;
+    };
+    if (!m_tableIndex.isEmpty() && matches(m_distanceTables[m_tableIndex.last()])) return m_tableIndex.last();
+    for (int t = 0; t < m_distanceTables.size(); ++t) {
+        if (matches(m_distanceTables[t])) return t;
+    }
+    QVector<float> table;
+    table.reserve(ray.gates.size());
+    for (const auto &g : ray.gates) table << g.distance;
+    m_distanceTables << table;
+    return m_distanceTables.size() - 1;
+}
+
+void CompactScanData::append(const RadarRay &ray) {
+    m_tableIndex << quint16(distanceTableFor(ray));
+    m_timeMs << ray.timestamp.toMSecsSinceEpoch();
+    m_azimuth << float(ray.azimuth);
+    m_elevation << float(ray.elevation);
+    for (const auto &g : ray.gates) {
+        m_speed << quantize(g.speed, SpeedScale);
+        m_snr << quantize(g.snr, SnrScale);
+        m_valid << quint8(g.isValid ? 1 : 0);
+    }
+    m_gateOffset << m_gateOffset.last() + int(ray.gates.size());
+}
+
+RangeGate CompactScanData::gate(int ray, int gate) const {
+    int k = m_gateOffset[ray] + gate;
+    RangeGate g;
+    g.distance = m_distanceTables[m_tableIndex[ray]][gate];
+    g.speed = float(m_speed[k] * SpeedScale);
+    g.snr = float(m_snr[k] * SnrScale);
+    g.turbulence = 0.0f;
+    g.isValid = m_valid[k] != 0;
+    return g;
+}
+
+RadarRay CompactScanData::ray(int i) const {
+    RadarRay r;
+    r.timestamp = timestamp(i);
+    r.azimuth = m_azimuth[i];
+    r.elevation = m_elevation[i];
+    int n = gateCount(i);
+    r.gates.resize(n);
+    for (int j = 0; j < n; ++j) r.gates[j] = gate(i, j);
+    return r;
+}
+
+qint64 CompactScanData::memoryBytes() const {
+    qint64 bytes = 0;
+    for (const auto &t : m_distanceTables) bytes += t.size() * sizeof(float);
+    bytes += m_tableIndex.size() * sizeof(quint16);
+    bytes += m_timeMs.size() * sizeof(qint64);
+    bytes += (m_azimuth.size() + m_elevation.size()) * sizeof(float);
+    bytes += m_gateOffset.size() * sizeof(int);
+    bytes += (m_speed.size() + m_snr.size()) * sizeof(qint16);
+    bytes += m_valid.size() * sizeof(quint8);
+    return bytes;
+}
+
+qint64 CompactScanData::memoryBytes(const ScanData &data) {
+    qint64 bytes = qint64(data.size()) * sizeof(RadarRay);
+    for (const auto &r : data) bytes += qint64(r.gates.size()) * sizeof(RangeGate);
+    return bytes;
+}
@@ -0,0 +1,52 @@
+#ifndef COMPACTSCAN_H
+#define COMPACTSCAN_H
+
+#include "datatypes.h"
+
+// 紧凑存储的原始扫描数据：
+//  - 距离门表每个扫描几何只存一份，射线只记录表索引
+//  - 风速、SNR 用 int16 定点数 (值 = 原始整数 * 比例)
+//  - 有效位按字节存放；湍流是派生量，不进入原始存储
+// 通过 ray()/gate() 访问时还原成普通的 RadarRay/RangeGate，调用方无需关心存储格式。
+class CompactScanData
+{
+public:
+    static constexpr double SpeedScale = 0.01; // m/s / LSB，可表示 ±327 m/s
+    static constexpr double SnrScale = 0.1;    // dB / LSB，可表示 ±3276 dB
+
+    static CompactScanData fromScan(const ScanData& data);
+    ScanData toScan() const;
+
+    void clear();
+    void reserve(int rays, int gatesPerRay);
+    void append(const RadarRay& ray);
+
+    int size() const { return m_azimuth.size(); }
+    bool isEmpty() const { return m_azimuth.isEmpty(); }
+    int gateCount(int ray) const { return m_gateOffset[ray + 1] - m_gateOffset[ray]; }
+
+    QDateTime timestamp(int ray) const { return QDateTime::fromMSecsSinceEpoch(m_timeMs[ray]); }
+    double azimuth(int ray) const { return m_azimuth[ray]; }
+    double elevation(int ray) const { return m_elevation[ray]; }
+    RangeGate gate(int ray, int gate) const;
+    RadarRay ray(int ray) const;
+
+    // 实际占用的字节数（用于状态栏显示与对比）
+    qint64 memoryBytes() const;
+    static qint64 memoryBytes(const ScanData& data);
+
+private:
+    int distanceTableFor(const RadarRay& ray);
+
+    QVector<QVector<float>> m_distanceTables; // 不同的距离门几何（通常只有一个）
+    QVector<quint16> m_tableIndex;            // 每条射线使用的距离门表
+    QVector<qint64> m_timeMs;
+    QVector<float> m_azimuth;
+    QVector<float> m_elevation;
+    QVector<int> m_gateOffset = QVector<int>{0}; // 射线 i 的门在 [offset[i], offset[i+1])
+    QVector<qint16> m_speed;
+    QVector<qint16> m_snr;
+    QVector<quint8> m_valid;
+};
+
+#endif // COMPACTSCAN_H
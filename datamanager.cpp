@@ -1,9 +1,11 @@
 #include "datamanager.h"
 #include <cmath>
+#include <QtMath>
 #include <QRegularExpression>
 #include <QMap>
 #include <QDateTime>
 #include <QDebug>
+#include <algorithm>
 
 DataManager::DataManager() {}
 
@@ -13,6 +15,7 @@ DataManager::DataManager() {}
 bool DataManager::loadData(const QString &anglePath, const QString &windPath)
 {
     m_rawData.clear();
+    m_compactRaw.clear();
 
     // Key: 时间戳(秒), Value: <方位角, 仰角>
     QMap<qint64, QPair<double, double>> angleMap;
@@ -165,7 +168,9 @@ bool DataManager::loadData(const QString &anglePath, const QString &windPath)
                 ray.gates.append(g);
                 col += 2;
             }
-            m_rawData.append(ray);
+            // 紧凑模式下边解析边压缩，避免整份 double 数据的峰值内存
+            if (m_compact) m_compactRaw.append(ray);
+            else m_rawData.append(ray);
             matchCount++;
         }
     }
@@ -174,8 +179,30 @@ bool DataManager::loadData(const QString &anglePath, const QString &windPath)
     qDebug() << ">>> 对齐完成！共生成射线数：" << matchCount;
     qDebug() << "    (如果此数字为0，说明两个文件时间差全部超过了3秒)";
 
-    m_processedData = m_rawData;
-    return !m_rawData.isEmpty();
+    if (m_compact) {
+        m_pipeline.setSource(m_compactRaw);
+        m_processedData = m_compactRaw.toScan();
+    } else {
+        m_pipeline.setSource(m_rawData);
+        m_processedData = m_rawData;
+    }
+    m_sweeps = detectSweeps(m_processedData);
+    // 混合扫描时 PPI 视图只画 PPI 射线，RHI 射线交给 RHI 视图
+    m_ppiMask.clear();
+    int rhiCount = 0;
+    for (const SweepInfo &s : m_sweeps)
+        if (s.type == Scan_RHI) rhiCount++;
+    if (rhiCount > 0) {
+        m_ppiMask.fill(true, m_processedData.size());
+        for (const SweepInfo &s : m_sweeps)
+            if (s.type == Scan_RHI) std::fill_n(m_ppiMask.begin() + s.firstRay, s.rayCount, false);
+    }
+    m_index.build(m_processedData, m_sweeps);
+    m_pyramid.clear(); // 旧文件的金字塔作废，新的由界面在后台建
+    m_vad.invalidate();
+    m_windDirty = true;
+    qDebug() << ">>> 划分出 sweep 数：" << m_sweeps.size() << "，其中 RHI：" << rhiCount;
+    return rawRayCount() > 0;
 }
 
 // ---------------------------------------------------------
@@ -183,38 +210,140 @@ bool DataManager::loadData(const QString &anglePath, const QString &windPath)
 // ---------------------------------------------------------
 const ScanData& DataManager::getScanData() const { return m_processedData; }
 
+// 各参数入口只修改自己那一项，由处理链决定需要重算哪些阶段
 void DataManager::applyFilter(double snrThreshold) {
-    m_processedData = m_rawData;
-    for (auto &r : m_processedData) {
-        for (auto &g : r.gates) {
-            if (g.snr < snrThreshold) g.isValid = false;
-        }
-    }
+    m_params.snrThreshold = snrThreshold;
+    runPipeline();
 }
 
 void DataManager::calculateTurbulence(int windowSize) {
-    if (windowSize < 2) windowSize = 2;
-    int halfWin = windowSize / 2;
-    for (auto &ray : m_processedData) {
-        int cnt = ray.gates.size();
-        QVector<double> ti(cnt, 0.0);
-        for (int i = 0; i < cnt; ++i) {
-            if (!ray.gates[i].isValid) continue;
-            int start = std::max(0, i - halfWin);
-            int end = std::min(cnt - 1, i + halfWin);
-            double sum = 0, ss = 0; int n = 0;
-            for (int k = start; k <= end; ++k) {
-                if (ray.gates[k].isValid) { sum += ray.gates[k].speed; n++; }
-            }
-            if (n < 2) continue;
-            double mean = sum / n;
-            for (int k = start; k <= end; ++k) {
-                if (ray.gates[k].isValid) ss += std::pow(ray.gates[k].speed - mean, 2);
-            }
-            ti[i] = (std::abs(mean) > 0.01) ? (std::sqrt(ss/n) / std::abs(mean)) : 0.0;
+    m_params.windowSize = windowSize;
+    runPipeline();
+}
+
+void DataManager::detectAndRepairOutliers(double diffThreshold) {
+    m_params.outlierThreshold = diffThreshold;
+    runPipeline();
+}
+
+void DataManager::setParams(const PipelineParams &params) {
+    m_params = params;
+    runPipeline();
+}
+
+void DataManager::setCompactStorage(bool enabled) {
+    if (enabled == m_compact) return;
+    m_compact = enabled;
+    if (enabled) {
+        m_compactRaw = CompactScanData::fromScan(m_rawData);
+        m_rawData.clear();
+        m_pipeline.setMaxCacheKB(0);
+        m_pipeline.setSource(m_compactRaw);
+    } else {
+        // 已量化的精度无法恢复，这里只是换回普通存储
+        m_rawData = m_compactRaw.toScan();
+        m_compactRaw.clear();
+        m_pipeline.setMaxCacheKB(ProcessingPipeline::DefaultCacheKB);
+        m_pipeline.setSource(m_rawData);
+    }
+    runPipeline();
+}
+
+qint64 DataManager::memoryUsageBytes() const {
+    qint64 raw = m_compact ? m_compactRaw.memoryBytes() : CompactScanData::memoryBytes(m_rawData);
+    return raw + CompactScanData::memoryBytes(m_processedData) + m_pipeline.cacheBytes() + m_pyramid.memoryBytes();
+}
+
+void DataManager::runPipeline() {
+    if (rawRayCount() == 0) return;
+    m_processedData = m_pipeline.run(m_params);
+    m_vad.invalidate();
+    m_windDirty = true;
+}
+
+SweepList DataManager::detectSweeps(const ScanData &data) {
+    SweepList sweeps;
+    if (data.isEmpty()) return sweeps;
+
+    // 扫描方式由相邻射线的运动判断：仰角变化为主是 RHI，方位变化为主是 PPI，几乎不动时沿用当前方式
+    const double still = 0.05;
+    auto stepType = [still](double dAz, double dEl, int &type) {
+        if (std::abs(dEl) > still && std::abs(dEl) > std::abs(dAz)) type = Scan_RHI;
+        else if (std::abs(dAz) > still) type = Scan_PPI;
+        else type = -1;
+    };
+
+    SweepInfo cur{0, 1, data[0].elevation};
+    int curType = -1;      // 第二条射线到来前未定
+    double rotated = 0.0;  // PPI：已累计转过的方位角；RHI：已扫过的仰角
+    double lastDEl = 0.0;  // RHI 的扫描方向，反向即开始新 sweep
+    double elSum = data[0].elevation;
+    double azX = std::cos(qDegreesToRadians(data[0].azimuth)), azY = std::sin(qDegreesToRadians(data[0].azimuth));
+
+    auto finish = [&]() {
+        cur.elevation = elSum / cur.rayCount;
+        cur.type = curType == Scan_RHI ? Scan_RHI : Scan_PPI;
+        cur.azimuth = std::fmod(qRadiansToDegrees(std::atan2(azY, azX)) + 360.0, 360.0);
+        sweeps << cur;
+    };
+
+    for (int i = 1; i < data.size(); ++i) {
+        const RadarRay &prev = data[i-1];
+        const RadarRay &ray = data[i];
+        double dAz = ray.azimuth - prev.azimuth;
+        while (dAz > 180) dAz -= 360;
+        while (dAz < -180) dAz += 360;
+        double dEl = ray.elevation - prev.elevation;
+        int type;
+        stepType(dAz, dEl, type);
+
+        bool newSweep = prev.timestamp.secsTo(ray.timestamp) > 60
+                        || (curType >= 0 && type >= 0 && type != curType);
+        if (curType == Scan_RHI) {
+            newSweep = newSweep || std::abs(dAz) > 0.5 || rotated + std::abs(dEl) > 180.0
+                       || (std::abs(dEl) > still && lastDEl * dEl < 0);
+        } else {
+            newSweep = newSweep || rotated + std::abs(dAz) >= 360.0 || std::abs(dEl) > 0.5;
         }
-        for (int i = 0; i < cnt; ++i) ray.gates[i].turbulence = ti[i];
+        if (newSweep) {
+            finish();
+            cur = SweepInfo{i, 1, ray.elevation};
+            curType = -1;
+            rotated = 0.0;
+            lastDEl = 0.0;
+            elSum = ray.elevation;
+            azX = std::cos(qDegreesToRadians(ray.azimuth));
+            azY = std::sin(qDegreesToRadians(ray.azimuth));
+        } else {
+            if (curType < 0) curType = type;
+            rotated += std::abs(curType == Scan_RHI ? dEl : dAz);
+            if (std::abs(dEl) > still) lastDEl = dEl;
+            cur.rayCount++;
+            elSum += ray.elevation;
+            azX += std::cos(qDegreesToRadians(ray.azimuth));
+            azY += std::sin(qDegreesToRadians(ray.azimuth));
+        }
+    }
+    finish();
+    return sweeps;
+}
+
+int DataManager::sweepOfRay(int rayIndex) const {
+    // sweep 按起始射线有序，二分查找
+    auto it = std::upper_bound(m_sweeps.begin(), m_sweeps.end(), rayIndex,
+                               [](int idx, const SweepInfo &s) { return idx < s.firstRay; });
+    if (it == m_sweeps.begin()) return -1;
+    int si = int(std::prev(it) - m_sweeps.begin());
+    const SweepInfo &s = m_sweeps[si];
+    return (rayIndex < s.firstRay + s.rayCount) ? si : -1;
+}
+
+const QVector<WindProfile> &DataManager::windProfiles() {
+    if (m_windDirty) {
+        m_windProfiles = m_vad.retrieve(m_processedData, m_sweeps);
+        m_windDirty = false;
     }
+    return m_windProfiles;
 }
 
 bool DataManager::exportToCSV(const QString &filePath) {
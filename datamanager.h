@@ -2,6 +2,10 @@
 #define DATAMANAGER_H
 
 #include "datatypes.h"
+#include "processingpipeline.h"
+#include "vadretrieval.h"
+#include "timepyramid.h"
+#include "spatialindex.h"
 #include <QString>
 #include <QFile>
 #include <QTextStream>
@@ -27,11 +31,60 @@ public:
     // 3. 数据导出
     bool exportToCSV(const QString& filePath);
 
+    // 4. 野值修复 (阈值 <= 0 表示关闭)
     void detectAndRepairOutliers(double diffThreshold);
 
+    // 一次性设置全部处理参数并运行处理链
+    void setParams(const PipelineParams& params);
+    const PipelineParams& params() const { return m_params; }
+    const ProcessingPipeline& pipeline() const { return m_pipeline; }
+
+    // 紧凑存储模式：原始数据改用 int16 定点存储，处理结果仍为普通 ScanData；
+    // 同时关闭处理链的逐阶段缓存（每个缓存阶段都是一份完整的 float 副本，比原始数据还大），
+    // 改参数时从紧凑原始数据重跑整条链，用时间换内存
+    void setCompactStorage(bool enabled);
+    bool isCompactStorage() const { return m_compact; }
+    int rawRayCount() const { return m_compact ? m_compactRaw.size() : m_rawData.size(); }
+    qint64 memoryUsageBytes() const; // 原始数据 + 展示数据 + 处理链缓存 + 金字塔的估算占用
+
+    // 5. 扫描 (sweep) 划分：方位角转满一圈、仰角改变或时间中断即开始新 sweep
+    static SweepList detectSweeps(const ScanData& data);
+    const SweepList& getSweeps() const { return m_sweeps; }
+    int sweepOfRay(int rayIndex) const;
+    // 每条射线是否属于 PPI 扫描；全部是 PPI 时为空
+    const QVector<bool>& ppiRayMask() const { return m_ppiMask; }
+
+    // 6. VAD 风廓线反演（按需计算，结果随处理参数失效）
+    const QVector<WindProfile>& windProfiles();
+    VadRetrieval& vad() { return m_vad; }
+
+    // 7. 时间多分辨率金字塔：整段重建较慢，这里不自动建，
+    //    由界面拿展示数据在后台线程 build，完成后 setPyramid 换上
+    const TimePyramid& getPyramid() const { return m_pyramid; }
+    void setPyramid(TimePyramid pyramid) { m_pyramid = std::move(pyramid); }
+
+    // 8. PPI 空间索引（只依赖几何，加载时构建一次）
+    const PPISpatialIndex& getSpatialIndex() const { return m_index; }
+
 private:
+    void runPipeline();
+
     ScanData m_rawData;       // 原始对齐数据
     ScanData m_processedData; // 经过过滤/计算后的展示数据
+    CompactScanData m_compactRaw; // 紧凑模式下的原始数据（此时 m_rawData 为空）
+    bool m_compact = false;
+
+    ProcessingPipeline m_pipeline; // 带逐阶段缓存的处理链
+    PipelineParams m_params;
+
+    SweepList m_sweeps;
+    QVector<bool> m_ppiMask;
+    VadRetrieval m_vad;
+    QVector<WindProfile> m_windProfiles;
+    bool m_windDirty = true;
+
+    TimePyramid m_pyramid;
+    PPISpatialIndex m_index;
 };
 
 #endif // DATAMANAGER_H
@@ -4,11 +4,13 @@
 #include <QVector>
 #include <QDateTime>
 
+// 激光雷达的测量精度远低于 double（风速约 0.01 m/s，SNR 约 0.1 dB），
+// 字段统一用 float 存储，计算时再提升为 double
 struct RangeGate {
-    double distance;   // 距离 (m)
-    double speed;      // 径向风速 (m/s)
-    double snr;        // 信噪比 (dB)
-    double turbulence; // 湍流强度
+    float distance;    // 距离 (m)
+    float speed;       // 径向风速 (m/s)
+    float snr;         // 信噪比 (dB)
+    float turbulence;  // 湍流强度
     bool isValid;      // 是否有效
 };
 
@@ -21,6 +23,23 @@ struct RadarRay {
 
 typedef QVector<RadarRay> ScanData;
 
+// 扫描方式：PPI 固定仰角转方位，RHI 固定方位扫仰角
+enum ScanType {
+    Scan_PPI,
+    Scan_RHI
+};
+
+// 一次完整扫描 (sweep) 在 ScanData 中的射线范围
+struct SweepInfo {
+    int firstRay;     // 起始射线索引
+    int rayCount;     // 射线数
+    double elevation; // 平均仰角
+    ScanType type = Scan_PPI;
+    double azimuth = 0.0; // RHI 的平均方位
+};
+
+typedef QVector<SweepInfo> SweepList;
+
 enum DisplayMode {
     Mode_Speed,
     Mode_Turbulence
@@ -0,0 +1,137 @@
+#include "gateseriesview.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QComboBox>
+#include <QLabel>
+#include <QElapsedTimer>
+
+GateSeriesView::GateSeriesView(QWidget *parent) : QWidget(parent), m_cache(MaxCacheKB) {
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(2);
+
+    QHBoxLayout *bar = new QHBoxLayout;
+    bar->setContentsMargins(6, 2, 6, 0);
+    m_gateBox = new QComboBox;
+    m_gateBox->setMinimumContentsLength(10);
+    m_fieldBox = new QComboBox;
+    m_fieldBox->addItems({ "径向风速", "SNR", "湍流强度" });
+    m_infoLabel = new QLabel;
+    m_infoLabel->setStyleSheet("color: gray;");
+    bar->addWidget(new QLabel("距离门时间序列:"));
+    bar->addWidget(m_gateBox);
+    bar->addWidget(m_fieldBox);
+    bar->addWidget(m_infoLabel);
+    bar->addStretch();
+    layout->addLayout(bar);
+
+    m_plot = new QCustomPlot;
+    m_plot->setBackground(QBrush(Qt::white));
+    m_plot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+    m_plot->axisRect()->setRangeDrag(Qt::Horizontal);
+    m_plot->axisRect()->setRangeZoom(Qt::Horizontal);
+    m_plot->setPlottingHint(QCP::phFastPolylines, true);
+    QSharedPointer<QCPAxisTickerDateTime> ticker(new QCPAxisTickerDateTime);
+    ticker->setDateTimeFormat("MM-dd\nHH:mm:ss");
+    m_plot->xAxis->setTicker(ticker);
+
+    // 细线、不抗锯齿：百万点时描线本身就是瓶颈
+    m_graph = m_plot->addGraph();
+    m_graph->setPen(QPen(QColor(30, 90, 200), 1));
+    m_graph->setAntialiased(false);
+    m_graph->setAdaptiveSampling(true);
+    m_graph->setLineStyle(QCPGraph::lsLine);
+    layout->addWidget(m_plot, 1);
+
+    connect(m_gateBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &GateSeriesView::setGate);
+    connect(m_fieldBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &GateSeriesView::setField);
+}
+
+void GateSeriesView::setData(const ScanData *data) {
+    m_data = data;
+    m_cache.clear();
+    m_times.clear();
+    m_sorted = true;
+    m_gate = -1;
+
+    QSignalBlocker block(m_gateBox);
+    m_gateBox->clear();
+    if (!m_data || m_data->isEmpty()) {
+        m_graph->data()->clear();
+        m_infoLabel->clear();
+        m_plot->replot();
+        return;
+    }
+
+    // 时间只换算一次，各距离门共用
+    m_times.resize(m_data->size());
+    for (int i = 0; i < m_data->size(); ++i) {
+        m_times[i] = m_data->at(i).timestamp.toMSecsSinceEpoch() / 1000.0;
+        if (i > 0 && m_times[i] < m_times[i - 1]) m_sorted = false;
+    }
+    for (const auto &g : m_data->first().gates) m_gateBox->addItem(QString("%1 m").arg(g.distance, 0, 'f', 0));
+
+    m_gate = qMin(m_gateBox->count() - 1, 10); // 默认取近处一个门，最前面几个常被盲区占满
+    m_gateBox->setCurrentIndex(m_gate);
+    m_plot->xAxis->setRange(m_times.first(), m_times.last() + 1.0);
+    showSeries();
+}
+
+void GateSeriesView::refresh() {
+    m_cache.clear();
+    showSeries();
+}
+
+void GateSeriesView::setGate(int gate) {
+    m_gate = gate;
+    showSeries();
+}
+
+void GateSeriesView::setField(int field) {
+    m_field = Field(field);
+    showSeries();
+}
+
+// 按列抽取当前字段，无效门不出点。
+// 超过缓存上限的单列 QCache 不收，但图上正在用的那份由 QCPGraph 持有，不受影响
+QSharedPointer<QCPGraphDataContainer> GateSeriesView::series(int gate, Field field) {
+    const int key = gate * 3 + field;
+    if (Series *cached = m_cache.object(key)) return cached->data;
+
+    QVector<QCPGraphData> col;
+    col.reserve(m_data->size());
+    for (int i = 0; i < m_data->size(); ++i) {
+        const QVector<RangeGate> &gates = m_data->at(i).gates;
+        if (gate >= gates.size() || !gates[gate].isValid) continue;
+        const RangeGate &g = gates[gate];
+        float v = field == Field_Speed ? g.speed : (field == Field_Snr ? g.snr : g.turbulence);
+        col.append(QCPGraphData(m_times[i], v));
+    }
+    col.squeeze();
+
+    QSharedPointer<QCPGraphDataContainer> data(new QCPGraphDataContainer);
+    data->set(col, m_sorted); // QVector 隐式共享，这里不深拷贝
+    const int cost = int(qMax<qint64>(1, qint64(col.size()) * sizeof(QCPGraphData) / 1024));
+    m_cache.insert(key, new Series{data}, cost);
+    return data;
+}
+
+void GateSeriesView::showSeries() {
+    if (!m_data || m_data->isEmpty() || m_gate < 0) return;
+    QElapsedTimer clock;
+    clock.start();
+    QSharedPointer<QCPGraphDataContainer> data = series(m_gate, m_field);
+    const qint64 extractMs = clock.elapsed();
+
+    m_graph->setData(data); // 共享容器，不复制
+    bool found = false;
+    QCPRange vr = m_graph->getValueRange(found);
+    if (found) {
+        double pad = qMax(1e-6, vr.size() * 0.05);
+        m_plot->yAxis->setRange(vr.lower - pad, vr.upper + pad);
+    }
+    static const char *labels[] = { "风速 (m/s)", "SNR (dB)", "湍流强度" };
+    m_plot->yAxis->setLabel(labels[m_field]);
+    m_infoLabel->setText(QString("%1 点，抽取 %2 ms").arg(data->size()).arg(extractMs));
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
@@ -0,0 +1,58 @@
+#ifndef GATESERIESVIEW_H
+#define GATESERIESVIEW_H
+
+#include <QWidget>
+#include <QCache>
+#include "datatypes.h"
+#include "qcustomplot.h"
+
+class QComboBox;
+class QLabel;
+
+// 单个距离门随时间的变化（整段数据，可达数百万点）：
+//  - 只抽取当前距离门的当前字段（每点 16 字节，百万射线就是十几 MB），
+//    QCPGraph 直接共享抽出的容器，重绘不再拷贝
+//  - 依赖 QCPGraph 的自适应采样，每个像素列只画极值，平移缩放与点数基本无关
+//  - 最近用过的 (门, 字段) 保留在按字节计的缓存里，数据处理参数变化时 refresh() 清空
+class GateSeriesView : public QWidget
+{
+    Q_OBJECT
+public:
+    enum Field { Field_Speed, Field_Snr, Field_Turbulence };
+
+    explicit GateSeriesView(QWidget *parent = nullptr);
+
+    void setData(const ScanData* data);
+    void refresh();
+
+    QCustomPlot* plot() const { return m_plot; }
+
+public slots:
+    void setGate(int gate);
+    void setField(int field);
+
+private:
+    struct Series {
+        QSharedPointer<QCPGraphDataContainer> data;
+    };
+
+    QSharedPointer<QCPGraphDataContainer> series(int gate, Field field);
+    void showSeries();
+
+    QCustomPlot* m_plot;
+    QCPGraph* m_graph;
+    QComboBox* m_gateBox;
+    QComboBox* m_fieldBox;
+    QLabel* m_infoLabel;
+
+    const ScanData* m_data = nullptr;
+    QVector<double> m_times; // 射线时间 (s)，与 TimeRangeView 的时间轴一致
+    bool m_sorted = true;    // 时间是否单调，决定容器要不要排序
+    int m_gate = -1;
+    Field m_field = Field_Speed;
+    QCache<int, Series> m_cache; // 键 = 门号 * 3 + 字段，成本单位：KB
+
+    static constexpr int MaxCacheKB = 64 * 1024;
+};
+
+#endif // GATESERIESVIEW_H
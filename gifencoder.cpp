@@ -0,0 +1,168 @@
+#include "gifencoder.h"
+#include <vector>
+#include <algorithm>
+#include <climits>
+
+static void putU16(QByteArray &out, int v) {
+    out.append(char(v & 0xFF));
+    out.append(char((v >> 8) & 0xFF));
+}
+
+QByteArray GifEncoder::header(const QSize &size, const QVector<QRgb> &palette, bool loop) {
+    QByteArray out("GIF89a");
+    putU16(out, size.width());
+    putU16(out, size.height());
+    out.append(char(0xF7)); // 有全局调色板，8 位色深，256 项
+    out.append(char(0));    // 背景色下标
+    out.append(char(0));    // 像素宽高比
+    for (int i = 0; i < 256; ++i) {
+        QRgb c = i < palette.size() ? palette[i] : qRgb(0, 0, 0);
+        out.append(char(qRed(c)));
+        out.append(char(qGreen(c)));
+        out.append(char(qBlue(c)));
+    }
+    if (loop) {
+        // NETSCAPE2.0 扩展：无限循环
+        out.append("\x21\xFF\x0B" "NETSCAPE2.0" "\x03\x01", 16);
+        putU16(out, 0);
+        out.append(char(0));
+    }
+    return out;
+}
+
+QByteArray GifEncoder::frame(const uchar *indices, int stride, const QRect &rect, int delayCs) {
+    QByteArray out;
+    // 图形控制扩展：处置方式 1 (保留)，延时
+    out.append("\x21\xF9\x04", 3);
+    out.append(char(1 << 2));
+    putU16(out, qMax(2, delayCs));
+    out.append(char(0));
+    out.append(char(0));
+
+    // 图像描述符，使用全局调色板
+    out.append(char(0x2C));
+    putU16(out, rect.left());
+    putU16(out, rect.top());
+    putU16(out, rect.width());
+    putU16(out, rect.height());
+    out.append(char(0));
+
+    out.append(char(8)); // LZW 最小码长
+    QByteArray data = lzw(indices, stride, rect);
+    for (int i = 0; i < data.size(); i += 255) {
+        int n = std::min(255, int(data.size()) - i);
+        out.append(char(n));
+        out.append(data.constData() + i, n);
+    }
+    out.append(char(0));
+    return out;
+}
+
+// ---------------------------------------------------------
+// LZW：字典用开放寻址哈希表 (前缀码, 字节) -> 码，满 4095 项时发清除码重来
+// ---------------------------------------------------------
+QByteArray GifEncoder::lzw(const uchar *indices, int stride, const QRect &rect) {
+    const int clearCode = 256, eoiCode = 257;
+    const int hashSize = 1 << 13;
+    std::vector<int> keys(hashSize, -1), vals(hashSize);
+
+    QByteArray out;
+    quint32 bits = 0;
+    int bitCount = 0;
+    int codeSize = 9;
+    auto write = [&](int code, int size) {
+        bits |= quint32(code) << bitCount;
+        bitCount += size;
+        while (bitCount >= 8) {
+            out.append(char(bits & 0xFF));
+            bits >>= 8;
+            bitCount -= 8;
+        }
+    };
+    auto reset = [&]() { std::fill(keys.begin(), keys.end(), -1); };
+
+    int maxCode = eoiCode;
+    write(clearCode, codeSize);
+
+    int cur = -1;
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        const uchar *row = indices + qsizetype(y) * stride;
+        for (int x = rect.left(); x <= rect.right(); ++x) {
+            int c = row[x];
+            if (cur < 0) { cur = c; continue; }
+
+            int key = (cur << 8) | c;
+            int h = (key * 2654435761u) >> 19 & (hashSize - 1);
+            while (keys[h] != -1 && keys[h] != key) h = (h + 1) & (hashSize - 1);
+            if (keys[h] == key) {
+                cur = vals[h];
+                continue;
+            }
+
+            write(cur, codeSize);
+            keys[h] = key;
+            vals[h] = ++maxCode;
+            if (maxCode >= (1 << codeSize)) ++codeSize;
+            if (maxCode == 4095) {
+                write(clearCode, codeSize);
+                reset();
+                codeSize = 9;
+                maxCode = eoiCode;
+            }
+            cur = c;
+        }
+    }
+    if (cur >= 0) {
+        write(cur, codeSize);
+        // 解码端读到最后这个码还会再加一项字典（编码端不加），码宽可能恰好在这里加一位
+        if (maxCode + 1 >= (1 << codeSize) && codeSize < 12) ++codeSize;
+    }
+    write(eoiCode, codeSize);
+    if (bitCount > 0) out.append(char(bits & 0xFF));
+    return out;
+}
+
+QVector<uchar> GifEncoder::buildQuantizer(const QVector<QRgb> &palette) {
+    QVector<uchar> lut(32 * 32 * 32);
+    for (int i = 0; i < lut.size(); ++i) {
+        int r = ((i >> 10) & 31) * 8 + 4, g = ((i >> 5) & 31) * 8 + 4, b = (i & 31) * 8 + 4;
+        int best = 0, bestDist = INT_MAX;
+        for (int k = 0; k < palette.size(); ++k) {
+            int dr = qRed(palette[k]) - r, dg = qGreen(palette[k]) - g, db = qBlue(palette[k]) - b;
+            int d = dr * dr + dg * dg + db * db;
+            if (d < bestDist) { bestDist = d; best = k; }
+        }
+        lut[i] = uchar(best);
+    }
+    return lut;
+}
+
+void GifEncoder::quantize(const QImage &img, const QVector<uchar> &quantizer, QVector<uchar> &out) {
+    const int w = img.width(), h = img.height();
+    out.resize(qsizetype(w) * h);
+    const uchar *q = quantizer.constData();
+    for (int y = 0; y < h; ++y) {
+        const QRgb *line = reinterpret_cast<const QRgb *>(img.constScanLine(y));
+        uchar *dst = out.data() + qsizetype(y) * w;
+        for (int x = 0; x < w; ++x) {
+            QRgb c = line[x];
+            dst[x] = q[((qRed(c) >> 3) << 10) | ((qGreen(c) >> 3) << 5) | (qBlue(c) >> 3)];
+        }
+    }
+}
+
+QRect GifEncoder::diffRect(const QVector<uchar> &a, const QVector<uchar> &b, const QSize &size) {
+    const int w = size.width(), h = size.height();
+    int x0 = w, x1 = -1, y0 = h, y1 = -1;
+    for (int y = 0; y < h; ++y) {
+        const uchar *ra = a.constData() + qsizetype(y) * w;
+        const uchar *rb = b.constData() + qsizetype(y) * w;
+        if (std::equal(ra, ra + w, rb)) continue;
+        int l = 0, r = w - 1;
+        while (ra[l] == rb[l]) ++l;
+        while (ra[r] == rb[r]) --r;
+        x0 = std::min(x0, l); x1 = std::max(x1, r);
+        y0 = std::min(y0, y); y1 = y;
+    }
+    return x1 < 0 ? QRect() : QRect(QPoint(x0, y0), QPoint(x1, y1));
+}
@@ -0,0 +1,31 @@
+#ifndef GIFENCODER_H
+#define GIFENCODER_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QImage>
+#include <QRect>
+
+// 最小的 GIF89a 编码器（无外部依赖）：
+//  - 全局调色板最多 256 色，像素先经 15 位 RGB 查找表量化为下标
+//  - 每帧独立做 LZW 压缩，可以在多个线程里并行编码，最后按顺序拼接
+//  - 帧只写变化区域的外接矩形，处置方式为“保留上一帧”
+class GifEncoder
+{
+public:
+    static QByteArray header(const QSize& size, const QVector<QRgb>& palette, bool loop = true);
+    // indices 为整帧的调色板下标（行宽 stride），只编码 rect 部分；delayCs 单位 1/100 秒
+    static QByteArray frame(const uchar* indices, int stride, const QRect& rect, int delayCs);
+    static QByteArray trailer() { return QByteArray(1, '\x3B'); }
+
+    // 15 位 RGB -> 最近调色板下标
+    static QVector<uchar> buildQuantizer(const QVector<QRgb>& palette);
+    static void quantize(const QImage& img, const QVector<uchar>& quantizer, QVector<uchar>& out);
+    // 两帧下标不同的外接矩形；完全相同时返回空矩形
+    static QRect diffRect(const QVector<uchar>& a, const QVector<uchar>& b, const QSize& size);
+
+private:
+    static QByteArray lzw(const uchar* indices, int stride, const QRect& rect);
+};
+
+#endif // GIFENCODER_H
@@ -1,8 +1,101 @@
 #include "mainwindow.h"
+#include "ppiexporter.h"
 #include <QApplication>
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+
+// 命令行里带 --export-sweeps / --export-animation 时走无界面批量导出，不创建任何窗口
+static bool wantsExport(int argc, char *argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "--export-sweeps") == 0 || qstrncmp(argv[i], "--export-sweeps=", 16) == 0) return true;
+        if (qstrcmp(argv[i], "--export-animation") == 0 || qstrncmp(argv[i], "--export-animation=", 19) == 0) return true;
+    }
+    return false;
+}
+
+// 用法: LidarVis --export-sweeps <目录> [--size 2048] [--mode speed|turbulence] [--snr -20] [--threads 0] 角度.csv 风速.csv
+//       LidarVis --export-animation <out.gif|目录> [--fps 20] [--rays-per-frame 0] [--size ...] 角度.csv 风速.csv
+static int runExport(int argc, char *argv[]) {
+    // 没有显示器时使用 offscreen 平台，QPainter 画字仍需要 QGuiApplication
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("批量导出每个扫描的 PPI 图像或回放动画");
+    parser.addHelpOption();
+    QCommandLineOption outOpt("export-sweeps", "输出目录", "dir");
+    QCommandLineOption animOpt("export-animation", "回放动画：.gif 文件或 PNG 序列目录", "path");
+    QCommandLineOption fpsOpt("fps", "GIF 动画帧率（PNG 序列无效）", "fps", "20");
+    QCommandLineOption stepOpt("rays-per-frame", "动画每帧新增射线数，0 为自动", "n", "0");
+    QCommandLineOption sizeOpt("size", "图像边长 (像素)，动画默认 800", "px");
+    QCommandLineOption modeOpt("mode", "speed 或 turbulence", "mode", "speed");
+    QCommandLineOption snrOpt("snr", "SNR 阈值 (dB)", "dB", "-20");
+    QCommandLineOption threadsOpt("threads", "并行线程数，0 为按核数", "n", "0");
+    parser.addOptions({ outOpt, animOpt, fpsOpt, stepOpt, sizeOpt, modeOpt, snrOpt, threadsOpt });
+    parser.addPositionalArgument("angle", "角度文件 (CSV)");
+    parser.addPositionalArgument("wind", "风速文件 (CSV)");
+    parser.process(app);
+
+    const QStringList files = parser.positionalArguments();
+    if (files.size() < 2) {
+        qCritical().noquote() << "需要角度文件与风速文件";
+        return 1;
+    }
+
+    DataManager manager;
+    if (!manager.loadData(files[0], files[1])) {
+        qCritical().noquote() << "解析失败: 无法对齐时间戳";
+        return 1;
+    }
+    PipelineParams params;
+    params.snrThreshold = parser.value(snrOpt).toDouble();
+    manager.setParams(params);
+
+    const bool animation = parser.isSet(animOpt);
+    PPIExportOptions opt;
+    int px = parser.isSet(sizeOpt) ? qBound(64, parser.value(sizeOpt).toInt(), 16384) : (animation ? 800 : 2048);
+    opt.size = QSize(px, px);
+    opt.mode = (parser.value(modeOpt) == "turbulence") ? Mode_Turbulence : Mode_Speed;
+    double lo, hi;
+    ColorMap::defaultRange(opt.mode, lo, hi);
+    opt.colors = ColorMap(ColorMap::Palette_Classic, lo, hi, opt.mode);
+    opt.threads = parser.value(threadsOpt).toInt();
+
+    QElapsedTimer clock;
+    clock.start();
+    if (animation) {
+        PPIAnimationOptions anim;
+        anim.image = opt;
+        anim.image.rayMask = manager.ppiRayMask();
+        const QString path = parser.value(animOpt);
+        anim.format = path.endsWith(".gif", Qt::CaseInsensitive) ? PPIAnimationOptions::Format_Gif
+                                                                 : PPIAnimationOptions::Format_PngSequence;
+        anim.fps = parser.value(fpsOpt).toDouble();
+        anim.raysPerFrame = parser.value(stepOpt).toInt();
+        const int total = PPIExporter::animationFrameCount(manager.getScanData(), anim);
+        int n = PPIExporter::exportAnimation(manager.getScanData(), path, anim, [](int done, int total) {
+            if (done % 100 == 0 || done == total) qInfo().noquote() << QString("%1/%2").arg(done).arg(total);
+        });
+        qInfo().noquote() << QString("已导出 %1/%2 帧，用时 %3 s").arg(n).arg(total).arg(clock.elapsed() / 1000.0, 0, 'f', 1);
+        return n == total ? 0 : 1;
+    }
+
+    const SweepList &sweeps = manager.getSweeps();
+    int n = PPIExporter::exportSweeps(manager.getScanData(), sweeps, parser.value(outOpt), opt, [](int done, int total) {
+        qInfo().noquote() << QString("%1/%2").arg(done).arg(total);
+    });
+    const int ppiCount = int(std::count_if(sweeps.begin(), sweeps.end(), [](const SweepInfo &s) { return s.type == Scan_PPI; }));
+    qInfo().noquote() << QString("已导出 %1/%2 张，用时 %3 s").arg(n).arg(ppiCount).arg(clock.elapsed() / 1000.0, 0, 'f', 1);
+    return n == ppiCount ? 0 : 1;
+}
 
 int main(int argc, char *argv[])
 {
+    if (wantsExport(argc, argv)) return runExport(argc, argv);
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
@@ -8,21 +8,30 @@
 #include <QMessageBox>
 #include <QStatusBar>
 #include <QFileInfo>
+#include <QtConcurrent>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include "ppiexporter.h"
+#ifdef QCUSTOMPLOT_USE_OPENGL
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOffscreenSurface>
+#endif
 
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     setupUi();
     resize(1250, 850); // 稍微加宽一点以容纳滑条
     setWindowTitle("测风雷达数据分析平台");
 
-    m_playTimer = new QTimer(this);
-    connect(m_playTimer, &QTimer::timeout, [=](){
-        m_playIndex += 2;
-        if (m_playIndex <= m_manager.getScanData().size()) m_ppi->setPlayLimit(m_playIndex);
-        else m_playTimer->stop();
-    });
 }
 
-MainWindow::~MainWindow() {}
+MainWindow::~MainWindow() {
+    // 批量出图的回调会访问本窗口
+    if (m_sweepExport) m_sweepExport->waitForFinished();
+    if (m_animExport) m_animExport->waitForFinished();
+    if (m_pyramidBuild) m_pyramidBuild->waitForFinished();
+}
 
 void MainWindow::setupUi() {
     QWidget *center = new QWidget;
@@ -66,6 +75,43 @@ void MainWindow::setupUi() {
 
     m_spinWinSize = new QSpinBox; m_spinWinSize->setRange(2, 20); m_spinWinSize->setValue(5);
 
+    m_outlierBox = new QDoubleSpinBox; m_outlierBox->setRange(0, 50); m_outlierBox->setValue(0);
+    m_outlierBox->setSingleStep(0.5); m_outlierBox->setSuffix(" m/s"); m_outlierBox->setSpecialValueText("关闭");
+
+    m_compactCheck = new QCheckBox("紧凑存储");
+    m_compactCheck->setToolTip("原始数据以 int16 定点数保存，适合加载长时间数据");
+
+    m_paletteBox = new QComboBox;
+    m_paletteBox->addItems(ColorMap::paletteNames());
+    m_scaleLoBox = new QDoubleSpinBox; m_scaleLoBox->setRange(-100, 100); m_scaleLoBox->setDecimals(2); m_scaleLoBox->setValue(-10);
+    m_scaleHiBox = new QDoubleSpinBox; m_scaleHiBox->setRange(-100, 100); m_scaleHiBox->setDecimals(2); m_scaleHiBox->setValue(10);
+
+    m_glCheck = new QCheckBox("OpenGL");
+    m_glCheck->setToolTip("用 GPU 着色器绘制 PPI 热力图，不可用时自动退回软件渲染");
+
+    m_plotGlCheck = new QCheckBox("图表GL");
+#ifdef QCUSTOMPLOT_USE_OPENGL
+    m_plotGlCheck->setToolTip("廓线、时间序列等图表用 OpenGL 帧缓冲绘制，失败时退回软件光栅");
+#else
+    m_plotGlCheck->setEnabled(false);
+    m_plotGlCheck->setToolTip("编译时未启用 (qmake CONFIG+=qcp_opengl)");
+#endif
+    QPushButton *btnPlotBench = new QPushButton("图表测速");
+    btnPlotBench->setToolTip("分别用软件光栅和 OpenGL 重绘各图表，比较 replot 耗时");
+
+    m_hudCheck = new QCheckBox("性能");
+    m_hudCheck->setToolTip("在 PPI 左上角显示绘制耗时、缓存命中等统计");
+    m_hoverCheck = new QCheckBox("悬停廓线");
+    m_hoverCheck->setChecked(true);
+    m_hoverCheck->setToolTip("廓线图跟随鼠标下的射线，移开后回到点选的射线");
+    m_overlayCheck = new QCheckBox("叠加廓线");
+    m_overlayCheck->setToolTip("在廓线图中叠画所选射线所在扫描的全部廓线，颜色表示时间先后");
+    m_overlayOffsetBox = new QDoubleSpinBox;
+    m_overlayOffsetBox->setRange(0, 10); m_overlayOffsetBox->setDecimals(2); m_overlayOffsetBox->setSingleStep(0.05);
+    m_overlayOffsetBox->setToolTip("相邻廓线沿数值轴错开的量，0 为直接叠加，大于 0 为瀑布图");
+    QPushButton *btnFrames = new QPushButton("帧时");
+    btnFrames->setToolTip("导出最近若干帧的绘制耗时直方图 (CSV)");
+
     // 【修改点 2】创建距离滑条控件组
     QWidget *rangeGroup = new QWidget;
     QVBoxLayout *rangeLayout = new QVBoxLayout(rangeGroup);
@@ -91,6 +137,12 @@ void MainWindow::setupUi() {
 
     QPushButton *btnExp = new QPushButton("📊 导出");
     QPushButton *btnShot = new QPushButton("📸 截图");
+    QPushButton *btnSweeps = new QPushButton("🖼 扫描出图");
+    btnSweeps->setToolTip("按当前模式/色标/距离范围，把每个扫描导出为 2048×2048 PNG");
+    QPushButton *btnMulti = new QPushButton("▦ 多视图");
+    btnMulti->setToolTip("并排对比多个扫描或时间窗，共用同一份数据");
+    QPushButton *btnAnim = new QPushButton("🎞 回放动画");
+    btnAnim->setToolTip("离线渲染整段回放，导出 GIF 或 PNG 序列");
 
     // 添加到工具栏布局
     toolLayout->addWidget(btnLoad);
@@ -105,6 +157,19 @@ void MainWindow::setupUi() {
     toolLayout->addLayout(paramLayout);
 
     toolLayout->addWidget(new QLabel("窗口:")); toolLayout->addWidget(m_spinWinSize);
+    toolLayout->addWidget(new QLabel("去野值:")); toolLayout->addWidget(m_outlierBox);
+    toolLayout->addWidget(m_compactCheck);
+    toolLayout->addWidget(m_glCheck);
+    toolLayout->addWidget(m_plotGlCheck);
+    toolLayout->addWidget(btnPlotBench);
+    toolLayout->addWidget(m_hudCheck);
+    toolLayout->addWidget(m_hoverCheck);
+    toolLayout->addWidget(m_overlayCheck);
+    toolLayout->addWidget(new QLabel("错开:")); toolLayout->addWidget(m_overlayOffsetBox);
+    toolLayout->addWidget(btnFrames);
+
+    toolLayout->addWidget(new QLabel("色标:")); toolLayout->addWidget(m_paletteBox);
+    toolLayout->addWidget(m_scaleLoBox); toolLayout->addWidget(new QLabel("~")); toolLayout->addWidget(m_scaleHiBox);
 
     toolLayout->addWidget(new QLabel("|")); // 分隔符
     toolLayout->addWidget(rangeGroup); // 加入滑条组
@@ -112,13 +177,24 @@ void MainWindow::setupUi() {
     toolLayout->addStretch();
     toolLayout->addWidget(btnExp);
     toolLayout->addWidget(btnShot);
+    toolLayout->addWidget(btnMulti);
+    toolLayout->addWidget(btnSweeps);
+    toolLayout->addWidget(btnAnim);
 
     // --- 可视化区域 (保持不变) ---
     QSplitter *vSplitter = new QSplitter(Qt::Vertical);
     vSplitter->setHandleWidth(4);
 
+    // PPI 与 RHI 并排，数据里没有 RHI 扫描时 RHI 视图隐藏
+    QSplitter *viewSplitter = new QSplitter(Qt::Horizontal);
+    viewSplitter->setHandleWidth(4);
     m_ppi = new PPIWidget;
-    vSplitter->addWidget(m_ppi);
+    m_rhi = new RHIWidget;
+    m_rhi->setVisible(false);
+    viewSplitter->addWidget(m_ppi);
+    viewSplitter->addWidget(m_rhi);
+    viewSplitter->setSizes(QList<int>() << 600 << 400);
+    vSplitter->addWidget(viewSplitter);
 
     QWidget *bottomArea = new QWidget;
     QHBoxLayout *hLayout = new QHBoxLayout(bottomArea);
@@ -126,6 +202,11 @@ void MainWindow::setupUi() {
     m_snrPlot = new QCustomPlot;
     m_speedPlot->setBackground(QBrush(Qt::white)); m_snrPlot->setBackground(QBrush(Qt::white));
 
+    // 叠加廓线放在主图层下面，当前射线的曲线始终在最上
+    m_speedPlot->addLayer("profiles", m_speedPlot->layer("main"), QCustomPlot::limBelow);
+    m_overlay = new ProfileOverlay(m_speedPlot->xAxis, m_speedPlot->yAxis);
+    m_overlay->setLayer("profiles");
+    m_overlay->setVisible(false);
     m_speedCurve = new QCPCurve(m_speedPlot->xAxis, m_speedPlot->yAxis);
     m_speedCurve->setPen(QPen(Qt::blue, 2));
     m_speedPlot->xAxis->setLabel("数值"); m_speedPlot->yAxis->setLabel("距离 (m)");
@@ -136,11 +217,52 @@ void MainWindow::setupUi() {
     m_snrPlot->xAxis->setLabel("SNR (dB)"); m_snrPlot->yAxis->setLabel("距离 (m)");
     m_snrPlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
 
-    hLayout->addWidget(m_speedPlot); hLayout->addWidget(m_snrPlot);
+    // VAD 风廓线：下轴水平风速，上轴风向
+    m_vadPlot = new QCustomPlot;
+    m_vadPlot->setBackground(QBrush(Qt::white));
+    m_vadSpeedCurve = new QCPCurve(m_vadPlot->xAxis, m_vadPlot->yAxis);
+    m_vadSpeedCurve->setPen(QPen(Qt::darkGreen, 2));
+    m_vadDirCurve = new QCPCurve(m_vadPlot->xAxis2, m_vadPlot->yAxis);
+    m_vadDirCurve->setPen(QPen(QColor(255, 140, 0), 1, Qt::DashLine));
+    m_vadDirCurve->setLineStyle(QCPCurve::lsNone);
+    m_vadDirCurve->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, 4));
+    m_vadPlot->xAxis->setLabel("水平风速 (m/s)"); m_vadPlot->yAxis->setLabel("高度 (m)");
+    m_vadPlot->xAxis2->setVisible(true); m_vadPlot->xAxis2->setLabel("风向 (°)");
+    m_vadPlot->xAxis2->setRange(0, 360);
+    m_vadPlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+
+    hLayout->addWidget(m_speedPlot); hLayout->addWidget(m_snrPlot); hLayout->addWidget(m_vadPlot);
     vSplitter->addWidget(bottomArea);
-    vSplitter->setSizes(QList<int>() << 500 << 300);
+
+    // 时间-距离热力图：整段数据随时间的变化
+    m_timeRange = new TimeRangeView;
+    vSplitter->addWidget(m_timeRange);
+    m_gateSeries = new GateSeriesView;
+    vSplitter->addWidget(m_gateSeries);
+    vSplitter->setSizes(QList<int>() << 450 << 250 << 200 << 150);
+
+    // --- 回放条：按数据时间播放，可暂停/拖动/调倍速 ---
+    QWidget *playBar = new QWidget;
+    playBar->setStyleSheet(style);
+    QHBoxLayout *playLayout = new QHBoxLayout(playBar);
+    playLayout->setContentsMargins(8, 2, 8, 2);
+    m_playBtn = new QPushButton("▶");
+    m_speedBox = new QComboBox;
+    for (int x : { 1, 10, 60, 100, 300, 1000 }) m_speedBox->addItem(QString("%1x").arg(x), x);
+    m_speedBox->setCurrentIndex(3);
+    m_timeSlider = new QSlider(Qt::Horizontal);
+    m_timeSlider->setRange(0, 0);
+    m_timeLabel = new QLabel("--:--:--");
+    playLayout->addWidget(m_playBtn);
+    playLayout->addWidget(new QLabel("倍速:")); playLayout->addWidget(m_speedBox);
+    playLayout->addWidget(m_timeSlider, 1);
+    playLayout->addWidget(m_timeLabel);
+
+    m_playback = new PlaybackEngine(this);
+    m_playback->setSpeed(m_speedBox->currentData().toDouble());
 
     mainLayout->addWidget(toolWidget);
+    mainLayout->addWidget(playBar);
     mainLayout->addWidget(vSplitter);
 
     statusBar()->setStyleSheet("background-color: #f0f0f0; border-top: 1px solid #ccc; color: black;");
@@ -151,8 +273,27 @@ void MainWindow::setupUi() {
     connect(btnLoad, &QPushButton::clicked, this, &MainWindow::loadFiles);
     connect(m_snrBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &MainWindow::updateFilter);
     connect(m_ppi, &PPIWidget::raySelected, this, &MainWindow::updateLinePlot);
+    connect(m_rhi, &RHIWidget::raySelected, this, &MainWindow::updateLinePlot);
+    connect(m_ppi, &PPIWidget::rayHovered, this, &MainWindow::onRayHovered);
+    connect(m_rhi, &RHIWidget::rayHovered, this, &MainWindow::onRayHovered);
+    connect(m_rhi, &RHIWidget::availabilityChanged, m_rhi, &RHIWidget::setVisible);
+    m_rhi->setColorMap(Mode_Speed, m_ppi->colorMap(Mode_Speed));
+    m_rhi->setColorMap(Mode_Turbulence, m_ppi->colorMap(Mode_Turbulence));
     connect(m_comboMode, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onModeChanged);
     connect(m_spinWinSize, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::onWindowSizeChanged);
+    connect(m_outlierBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &MainWindow::onOutlierChanged);
+    connect(m_compactCheck, &QCheckBox::toggled, this, &MainWindow::onCompactToggled);
+    connect(m_glCheck, &QCheckBox::toggled, this, &MainWindow::onGLToggled);
+    connect(m_plotGlCheck, &QCheckBox::toggled, this, &MainWindow::onPlotGLToggled);
+    connect(btnPlotBench, &QPushButton::clicked, this, &MainWindow::onBenchmarkPlots);
+    connect(m_hudCheck, &QCheckBox::toggled, m_ppi, &PPIWidget::setStatsOverlayVisible);
+    connect(m_overlayCheck, &QCheckBox::toggled, this, &MainWindow::onOverlayChanged);
+    connect(m_overlayOffsetBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &MainWindow::onOverlayChanged);
+    connect(btnFrames, &QPushButton::clicked, this, &MainWindow::onExportFrameTimes);
+    connect(m_paletteBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onColorScaleChanged);
+    connect(m_scaleLoBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &MainWindow::onColorScaleChanged);
+    connect(m_scaleHiBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &MainWindow::onColorScaleChanged);
+    connect(m_ppi, &PPIWidget::renderBackendFallback, this, &MainWindow::onRenderFallback);
     connect(btnExp, &QPushButton::clicked, this, &MainWindow::onExportData);
 
     // 【修改点 3】距离控件双向绑定 (滑条 <-> SpinBox)
@@ -166,6 +307,22 @@ void MainWindow::setupUi() {
     connect(m_maxDistBox, QOverload<int>::of(&QSpinBox::valueChanged), m_maxSlider, &QSlider::setValue);
     connect(m_maxSlider, &QSlider::valueChanged, this, &MainWindow::onRangeChanged);
 
+    connect(m_playback, &PlaybackEngine::limitChanged, m_ppi, &PPIWidget::setPlayLimit);
+    connect(m_playback, &PlaybackEngine::limitChanged, m_rhi, &RHIWidget::setPlayLimit);
+    connect(m_playback, &PlaybackEngine::positionChanged, this, &MainWindow::onPlaybackPosition);
+    connect(m_playback, &PlaybackEngine::stateChanged, this, [=](bool playing) { m_playBtn->setText(playing ? "⏸" : "▶"); });
+    connect(m_playBtn, &QPushButton::clicked, m_playback, &PlaybackEngine::toggle);
+    connect(m_speedBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [=]() {
+        m_playback->setSpeed(m_speedBox->currentData().toDouble());
+    });
+    // 滑条单位 0.1 s；引擎回写位置时屏蔽信号，这里只响应用户拖动
+    connect(m_timeSlider, &QSlider::valueChanged, this, [=](int v) {
+        m_playback->seek(m_playback->startTime() + qint64(v) * 100);
+    });
+
+    connect(btnMulti, &QPushButton::clicked, this, &MainWindow::onShowMultiView);
+    connect(btnSweeps, &QPushButton::clicked, this, &MainWindow::onExportSweeps);
+    connect(btnAnim, &QPushButton::clicked, this, &MainWindow::onExportAnimation);
     connect(btnShot, &QPushButton::clicked, [=](){
         QString p = QFileDialog::getSaveFileName(this, "截图", "Radar.png", "Images (*.png)");
         if(!p.isEmpty()) this->grab().save(p);
@@ -190,6 +347,9 @@ void MainWindow::onRangeChanged() {
     }
 
     m_ppi->setDistanceRange(min, max);
+    m_rhi->setDistanceRange(min, max);
+    m_overlay->setDistanceRange(min, max);
+    if (m_multiView) m_multiView->setDistanceRange(min, max);
     m_speedPlot->yAxis->setRange(min, max);
     m_snrPlot->yAxis->setRange(min, max);
     m_speedPlot->replot();
@@ -198,10 +358,12 @@ void MainWindow::onRangeChanged() {
 
 void MainWindow::updateStatusBar() {
     QString modeStr = (m_currentMode == Mode_Turbulence) ? "湍流强度" : "径向风速";
-    QString text = QString("当前文件: %1  |  扫描模式: %2  |  数据行数: %3")
+    QString text = QString("当前文件: %1  |  扫描模式: %2  |  数据行数: %3  |  内存: %4 MB%5")
                        .arg(m_currentFileName)
                        .arg(modeStr)
-                       .arg(m_manager.getScanData().size());
+                       .arg(m_manager.getScanData().size())
+                       .arg(m_manager.memoryUsageBytes() / (1024.0 * 1024.0), 0, 'f', 1)
+                       .arg(m_manager.isCompactStorage() ? " (紧凑)" : "");
     m_statusLabel->setText(text);
 }
 
@@ -210,10 +372,29 @@ void MainWindow::loadFiles() {
     QString w = QFileDialog::getOpenFileName(this, "选择风速文件", "", "CSV (*.csv)"); if(w.isEmpty()) return;
     m_currentFileName = QFileInfo(w).fileName();
     if (m_manager.loadData(a, w)) {
-        m_manager.applyFilter(m_snrBox->value());
-        m_manager.calculateTurbulence(m_spinWinSize->value());
+        PipelineParams params;
+        params.snrThreshold = m_snrBox->value();
+        params.outlierThreshold = m_outlierBox->value();
+        params.windowSize = m_spinWinSize->value();
+        m_manager.setParams(params);
         m_ppi->setData(&m_manager.getScanData());
-        m_playIndex = 0; m_playTimer->start(25);
+        m_ppi->setPyramid(&m_manager.getPyramid());
+        m_ppi->setSpatialIndex(&m_manager.getSpatialIndex());
+        m_ppi->setRayMask(&m_manager.ppiRayMask()); // 混合扫描时 PPI 不画 RHI 射线
+        m_rhi->setData(&m_manager.getScanData(), &m_manager.getSweeps());
+        m_timeRange->setData(&m_manager.getScanData(), &m_manager.getPyramid());
+        m_timeRange->setRayMask(&m_manager.ppiRayMask()); // 和金字塔一致，只统计 PPI 射线
+        m_gateSeries->setData(&m_manager.getScanData());
+        if (m_multiView) m_multiView->setData(&m_manager.getScanData(), &m_manager.getSweeps(),
+                                              &m_manager.getSpatialIndex(), &m_manager.getPyramid(),
+                                              &m_manager.ppiRayMask());
+        m_playback->setData(m_manager.getScanData());
+        rebuildPyramid();
+        {
+            QSignalBlocker block(m_timeSlider);
+            m_timeSlider->setRange(0, int((m_playback->endTime() - m_playback->startTime()) / 100));
+        }
+        m_playback->play();
         updateLinePlot(m_manager.getScanData().size()/2);
         updateStatusBar();
     } else {
@@ -224,45 +405,437 @@ void MainWindow::loadFiles() {
 void MainWindow::updateLinePlot(int idx) {
     const ScanData& data = m_manager.getScanData();
     if (idx < 0 || idx >= data.size()) return;
-    const RadarRay& ray = data[idx];
-    QVector<double> dists, vals, snrs;
-    for (const auto& g : ray.gates) {
+    m_selectedRay = idx;
+    updateOverlay(idx);
+    showProfile(idx);
+    updateVadPlot(idx);
+}
+
+void MainWindow::onOverlayChanged() {
+    updateOverlay(m_selectedRay);
+    showProfile(m_selectedRay);
+}
+
+// 叠画所选射线所在的整个扫描；不属于任何扫描时取前后 200 条射线
+void MainWindow::updateOverlay(int idx) {
+    const ScanData& data = m_manager.getScanData();
+    const bool on = m_overlayCheck->isChecked() && idx >= 0 && idx < data.size();
+    m_overlay->setVisible(on);
+    if (!on) return;
+
+    int begin = qMax(0, idx - 200), end = qMin(int(data.size()), idx + 200);
+    int si = m_manager.sweepOfRay(idx);
+    if (si >= 0 && si < m_manager.getSweeps().size()) {
+        const SweepInfo& s = m_manager.getSweeps()[si];
+        begin = s.firstRay;
+        end = s.firstRay + s.rayCount;
+    }
+    m_overlay->setMode(m_currentMode);
+    m_overlay->setOffset(m_overlayOffsetBox->value());
+    m_overlay->setDistanceRange(m_minDistBox->value(), m_maxDistBox->value());
+    m_overlay->setSource(&data, begin, end);
+}
+
+// 悬停只换廓线，VAD 按 sweep 变化，留给点选
+void MainWindow::onRayHovered(int idx) {
+    if (!m_hoverCheck->isChecked()) return;
+    showProfile(idx >= 0 ? idx : m_selectedRay);
+}
+
+// 廓线数据容器按距离门数预先分配，之后每次原地改写 key/value，不重建、不排序。
+// 无效门沿用前一个有效门的坐标（首段用第一个有效门），画出来与直接跳过无效门相同
+void MainWindow::fillProfile(QCPCurve *curve, const RadarRay &ray, bool snr, double &lo, double &hi) {
+    QSharedPointer<QCPCurveDataContainer> c = curve->data();
+    const int n = ray.gates.size();
+    if (c->size() != n) {
+        QVector<QCPCurveData> pts(n);
+        for (int j = 0; j < n; ++j) pts[j].t = j;
+        c->set(pts, true);
+    }
+
+    lo = qInf(); hi = -qInf();
+    int first = -1;
+    for (int j = 0; j < n && first < 0; ++j)
+        if (ray.gates[j].isValid) first = j;
+    double key = 0, value = 0;
+    if (first >= 0) {
+        const RangeGate &g = ray.gates[first];
+        key = snr ? g.snr : (m_currentMode == Mode_Turbulence ? g.turbulence : g.speed);
+        value = g.distance;
+    }
+    auto it = c->begin();
+    for (int j = 0; j < n; ++j, ++it) {
+        const RangeGate &g = ray.gates[j];
         if (g.isValid) {
-            dists << g.distance; snrs << g.snr;
-            vals << (m_currentMode == Mode_Turbulence ? g.turbulence : g.speed);
+            key = snr ? g.snr : (m_currentMode == Mode_Turbulence ? g.turbulence : g.speed);
+            value = g.distance;
+            lo = qMin(lo, key); hi = qMax(hi, key);
         }
+        it->key = key;
+        it->value = value;
     }
-    m_speedCurve->setData(vals, dists);
-    m_speedPlot->rescaleAxes();
-    m_speedPlot->yAxis->setRange(m_minDistBox->value(), m_maxDistBox->value()); // 遵循滑条范围
-    m_speedPlot->replot();
+}
 
-    m_snrCurve->setData(snrs, dists);
-    m_snrPlot->rescaleAxes();
-    m_snrPlot->yAxis->setRange(m_minDistBox->value(), m_maxDistBox->value());
-    m_snrPlot->replot();
+void MainWindow::showProfile(int idx) {
+    const ScanData& data = m_manager.getScanData();
+    if (idx < 0 || idx >= data.size()) return;
+    const RadarRay& ray = data[idx];
+    const QCPRange dist(m_minDistBox->value(), m_maxDistBox->value()); // 遵循滑条范围
+
+    double lo, hi;
+    fillProfile(m_speedCurve, ray, false, lo, hi);
+    if (m_overlay->visible()) {
+        bool found = false;
+        QCPRange r = m_overlay->getKeyRange(found);
+        if (found) { lo = qMin(lo, r.lower); hi = qMax(hi, r.upper); }
+    }
+    if (lo <= hi) m_speedPlot->xAxis->setRange(lo - 0.05 * (hi - lo + 1e-6), hi + 0.05 * (hi - lo + 1e-6));
+    m_speedPlot->yAxis->setRange(dist);
+    m_speedPlot->replot(QCustomPlot::rpQueuedReplot); // 同一轮事件里多次更新只重绘一次
+
+    fillProfile(m_snrCurve, ray, true, lo, hi);
+    if (lo <= hi) m_snrPlot->xAxis->setRange(lo - 0.05 * (hi - lo + 1e-6), hi + 0.05 * (hi - lo + 1e-6));
+    m_snrPlot->yAxis->setRange(dist);
+    m_snrPlot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+void MainWindow::updateVadPlot(int rayIndex) {
+    int si = m_manager.sweepOfRay(rayIndex);
+    const QVector<WindProfile>& profiles = m_manager.windProfiles();
+    if (si < 0 || si >= profiles.size()) return;
+
+    const WindProfile& prof = profiles[si];
+    QVector<double> hs, spd, dir;
+    for (int j = 0; j < prof.valid.size(); ++j) {
+        if (!prof.valid[j]) continue;
+        hs << prof.height[j]; spd << prof.speed[j]; dir << prof.direction[j];
+    }
+    m_vadSpeedCurve->setData(spd, hs);
+    m_vadDirCurve->setData(dir, hs);
+    m_vadPlot->xAxis->rescale();
+    m_vadPlot->yAxis->rescale();
+    m_vadPlot->xAxis2->setRange(0, 360);
+    m_vadPlot->xAxis->setLabel(QString("水平风速 (m/s)  [sweep %1, 仰角 %2°]").arg(si + 1).arg(prof.elevation, 0, 'f', 1));
+    m_vadPlot->replot();
 }
 
 void MainWindow::updateFilter(double val) {
     m_manager.applyFilter(val);
-    m_manager.calculateTurbulence(m_spinWinSize->value());
-    m_ppi->update();
-    if(!m_manager.getScanData().isEmpty()) updateLinePlot(m_manager.getScanData().size()/2);
+    refreshViews();
+    updateLinePlot(m_selectedRay);
 }
 
 void MainWindow::onModeChanged(int) {
     m_currentMode = (DisplayMode)m_comboMode->currentData().toInt();
     m_ppi->setDisplayMode(m_currentMode);
+    m_rhi->setDisplayMode(m_currentMode);
+    if (m_multiView) m_multiView->setDisplayMode(m_currentMode, m_ppi->colorMap());
+    syncColorScaleBoxes();
     m_speedPlot->xAxis->setLabel(m_currentMode == Mode_Turbulence ? "湍流强度" : "风速 (m/s)");
     m_speedPlot->replot();
-    if(!m_manager.getScanData().isEmpty()) updateLinePlot(m_manager.getScanData().size()/2);
+    updateLinePlot(m_selectedRay);
     updateStatusBar();
 }
 
 void MainWindow::onWindowSizeChanged(int v) {
     m_manager.calculateTurbulence(v);
-    m_ppi->update();
-    if(!m_manager.getScanData().isEmpty()) updateLinePlot(m_manager.getScanData().size()/2);
+    refreshViews();
+    updateLinePlot(m_selectedRay);
+}
+
+void MainWindow::onOutlierChanged(double v) {
+    m_manager.detectAndRepairOutliers(v);
+    refreshViews();
+    updateLinePlot(m_selectedRay);
+}
+
+void MainWindow::onCompactToggled(bool on) {
+    m_manager.setCompactStorage(on);
+    refreshViews();
+    updateStatusBar();
+}
+
+// 色标控件只作用于当前模式，切换模式时换成该模式自己的设置
+void MainWindow::syncColorScaleBoxes() {
+    ColorMap cm = m_ppi->colorMap(m_currentMode);
+    QSignalBlocker b1(m_paletteBox), b2(m_scaleLoBox), b3(m_scaleHiBox);
+    m_paletteBox->setCurrentIndex(cm.palette());
+    double step = (m_currentMode == Mode_Turbulence) ? 0.05 : 1.0;
+    m_scaleLoBox->setSingleStep(step); m_scaleHiBox->setSingleStep(step);
+    m_scaleLoBox->setValue(cm.lo());
+    m_scaleHiBox->setValue(cm.hi());
+}
+
+void MainWindow::onColorScaleChanged() {
+    double lo = m_scaleLoBox->value(), hi = m_scaleHiBox->value();
+    if (hi <= lo) return; // 值域无效时先不更新，等用户改完
+    m_ppi->setColorScale(m_currentMode, ColorMap::Palette(m_paletteBox->currentIndex()), lo, hi);
+    if (m_multiView) m_multiView->setColorMap(m_currentMode, m_ppi->colorMap()); // 与主视图共用同一张表
+    m_timeRange->setColorMap(m_currentMode, m_ppi->colorMap());
+    m_rhi->setColorMap(m_currentMode, m_ppi->colorMap());
+}
+
+void MainWindow::refreshViews() {
+    m_ppi->refresh();
+    m_rhi->refresh();
+    m_timeRange->refresh();
+    m_gateSeries->refresh();
+    if (m_multiView) m_multiView->refresh();
+    rebuildPyramid();
+}
+
+// 金字塔整段重建要扫一遍全部射线，放到后台线程。
+// 连续拖动参数时只保留最后一次，中间结果直接丢弃
+void MainWindow::rebuildPyramid() {
+    if (!m_pyramidBuild) {
+        m_pyramidBuild = new QFutureWatcher<TimePyramid>(this);
+        connect(m_pyramidBuild, &QFutureWatcher<TimePyramid>::finished, this, [this]() {
+            if (m_pyramidPending) {
+                m_pyramidPending = false;
+                rebuildPyramid();
+                return;
+            }
+            m_manager.setPyramid(m_pyramidBuild->result());
+            m_ppi->pyramidUpdated();
+            m_timeRange->refresh();
+            if (m_multiView) m_multiView->pyramidUpdated();
+            updateStatusBar();
+        });
+    }
+    // 旧金字塔是按旧参数建的，和原始射线混着画会新旧不一：先撤掉，建好之前一律画原始射线
+    if (!m_manager.getPyramid().isEmpty()) {
+        m_manager.setPyramid(TimePyramid());
+        m_ppi->pyramidUpdated();
+        m_timeRange->refresh();
+        if (m_multiView) m_multiView->pyramidUpdated();
+    }
+    if (m_pyramidBuild->isRunning()) {
+        m_pyramidPending = true;
+        return;
+    }
+    ScanData data = m_manager.getScanData(); // 隐式共享，后台建的是这一刻的数据
+    QVector<bool> mask = m_manager.ppiRayMask();
+    m_pyramidBuild->setFuture(QtConcurrent::run([data, mask]() {
+        TimePyramid pyramid;
+        pyramid.build(data, mask);
+        return pyramid;
+    }));
+}
+
+// 多视图窗口：与主窗口共用同一份数据，只在第一次打开时创建
+void MainWindow::onShowMultiView() {
+    if (!m_multiView) {
+        m_multiView = new PPIMultiView(this);
+        m_multiView->setWindowFlag(Qt::Window);
+        m_multiView->setWindowTitle("多视图对比");
+        m_multiView->resize(1000, 800);
+        m_multiView->setColorMap(Mode_Speed, m_ppi->colorMap(Mode_Speed));
+        m_multiView->setColorMap(Mode_Turbulence, m_ppi->colorMap(Mode_Turbulence));
+        m_multiView->setDisplayMode(m_currentMode, m_ppi->colorMap());
+        m_multiView->setDistanceRange(m_minDistBox->value(), m_maxDistBox->value());
+        m_multiView->setData(&m_manager.getScanData(), &m_manager.getSweeps(), &m_manager.getSpatialIndex(),
+                             &m_manager.getPyramid(), &m_manager.ppiRayMask());
+        connect(m_multiView, &PPIMultiView::raySelected, this, &MainWindow::updateLinePlot);
+    }
+    m_multiView->show();
+    m_multiView->raise();
+    m_multiView->activateWindow();
+}
+
+void MainWindow::onGLToggled(bool on) {
+    m_ppi->setRenderBackend(on ? PPIWidget::Backend_OpenGL : PPIWidget::Backend_Software);
+    m_ppi->resetFrameStats(); // 切换后端后重新统计，便于对比
+}
+
+QList<QCustomPlot*> MainWindow::allPlots() const {
+    return { m_speedPlot, m_snrPlot, m_vadPlot, m_timeRange->plot(), m_gateSeries->plot() };
+}
+
+// 任何一个图表建不起 OpenGL 上下文就全部退回软件光栅，避免一半一半
+bool MainWindow::setPlotsOpenGl(bool on) {
+    bool ok = true;
+    for (QCustomPlot *plot : allPlots()) {
+        plot->setOpenGl(on);
+        if (on && !plot->openGl()) { ok = false; break; }
+    }
+    if (on && !ok) {
+        for (QCustomPlot *plot : allPlots()) plot->setOpenGl(false);
+    }
+    for (QCustomPlot *plot : allPlots()) plot->replot(QCustomPlot::rpQueuedReplot);
+    return on && ok;
+}
+
+void MainWindow::onPlotGLToggled(bool on) {
+    if (setPlotsOpenGl(on) != on) {
+        QSignalBlocker block(m_plotGlCheck);
+        m_plotGlCheck->setChecked(false);
+        statusBar()->showMessage("图表无法使用 OpenGL，已退回软件光栅", 5000);
+    }
+}
+
+// 当前 OpenGL 实现的名字，用来分辨真显卡和 llvmpipe 之类的软件实现
+static QString glRendererName() {
+#ifdef QCUSTOMPLOT_USE_OPENGL
+    QOffscreenSurface surface;
+    surface.create();
+    QOpenGLContext context;
+    if (!context.create() || !context.makeCurrent(&surface)) return "不可用";
+    QString name = QString::fromLatin1(reinterpret_cast<const char *>(context.functions()->glGetString(GL_RENDERER)));
+    context.doneCurrent();
+    return name;
+#else
+    return "未编译";
+#endif
+}
+
+// 两种模式下各图表的平均 replot 耗时；测完恢复到复选框对应的模式
+void MainWindow::onBenchmarkPlots() {
+    const int warmup = 3, runs = 20;
+    QStringList names = { "风速廓线", "SNR 廓线", "VAD", "时间-距离", "距离门序列" };
+    QList<QCustomPlot*> plots = allPlots();
+    QVector<double> ms[2];
+    bool glAvailable = false;
+
+    for (int mode = 0; mode < 2; ++mode) {
+        if (mode == 1) {
+#ifdef QCUSTOMPLOT_USE_OPENGL
+            glAvailable = setPlotsOpenGl(true);
+#endif
+            if (!glAvailable) break;
+        } else {
+            setPlotsOpenGl(false);
+        }
+        for (QCustomPlot *plot : plots) {
+            for (int i = 0; i < warmup; ++i) plot->replot(QCustomPlot::rpImmediateRefresh);
+            double sum = 0.0;
+            for (int i = 0; i < runs; ++i) {
+                plot->replot(QCustomPlot::rpImmediateRefresh);
+                sum += plot->replotTime();
+            }
+            ms[mode] << sum / runs;
+        }
+    }
+    const bool glOn = setPlotsOpenGl(m_plotGlCheck->isChecked());
+    if (m_plotGlCheck->isChecked() && !glOn) {
+        QSignalBlocker block(m_plotGlCheck);
+        m_plotGlCheck->setChecked(false);
+    }
+
+    QString text = QString("OpenGL 实现: %1\n\n图表\t软件光栅\tOpenGL\n").arg(glRendererName());
+    for (int i = 0; i < plots.size(); ++i) {
+        text += QString("%1\t%2 ms\t%3\n").arg(names.value(i)).arg(ms[0][i], 0, 'f', 2)
+                    .arg(glAvailable ? QString("%1 ms").arg(ms[1][i], 0, 'f', 2) : QString("-"));
+    }
+    QMessageBox::information(this, "图表重绘耗时", text);
+}
+
+// 每个扫描一张高分辨率 PNG，在后台线程并行渲染，界面不阻塞
+void MainWindow::onExportSweeps() {
+    if (m_manager.getSweeps().isEmpty()) return;
+    if (m_sweepExport && m_sweepExport->isRunning()) return;
+    QString dir = QFileDialog::getExistingDirectory(this, "选择输出目录");
+    if (dir.isEmpty()) return;
+
+    PPIExportOptions opt;
+    opt.mode = m_currentMode;
+    opt.colors = m_ppi->colorMap();
+    opt.minDist = m_minDistBox->value();
+    opt.maxDist = m_maxDistBox->value();
+    // 数据按值拷贝（隐式共享），导出期间改参数不影响正在出的图
+    ScanData data = m_manager.getScanData();
+    SweepList sweeps = m_manager.getSweeps();
+
+    if (!m_sweepExport) {
+        m_sweepExport = new QFutureWatcher<int>(this);
+        connect(m_sweepExport, &QFutureWatcher<int>::finished, this, [this]() {
+            statusBar()->showMessage(QString("扫描出图完成: %1 张").arg(m_sweepExport->result()), 5000);
+        });
+    }
+    m_sweepExport->setFuture(QtConcurrent::run([this, data, sweeps, dir, opt]() {
+        return PPIExporter::exportSweeps(data, sweeps, dir, opt, [this](int done, int total) {
+            QMetaObject::invokeMethod(this, [this, done, total]() {
+                statusBar()->showMessage(QString("正在出图 %1/%2 ...").arg(done).arg(total));
+            }, Qt::QueuedConnection);
+        });
+    }));
+}
+
+// 回放动画离线导出：不走 25 ms 定时器，按帧并行渲染
+void MainWindow::onExportAnimation() {
+    if (m_manager.getScanData().isEmpty()) return;
+    if (m_animExport && m_animExport->isRunning()) return;
+
+    QDialog dlg(this);
+    dlg.setWindowTitle("导出回放动画");
+    QFormLayout *form = new QFormLayout(&dlg);
+    QComboBox *fmtBox = new QComboBox;
+    fmtBox->addItems({ "GIF 动画", "PNG 序列" });
+    QSpinBox *sizeBox = new QSpinBox;
+    sizeBox->setRange(128, 4096); sizeBox->setSingleStep(64); sizeBox->setValue(800); sizeBox->setSuffix(" px");
+    QDoubleSpinBox *fpsBox = new QDoubleSpinBox;
+    fpsBox->setRange(1, 60); fpsBox->setValue(20); fpsBox->setSuffix(" fps");
+    QSpinBox *stepBox = new QSpinBox;
+    stepBox->setRange(0, 100000); stepBox->setSpecialValueText("自动");
+    form->addRow("格式", fmtBox);
+    form->addRow("分辨率", sizeBox);
+    form->addRow("帧率", fpsBox);
+    form->addRow("每帧射线数", stepBox);
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(buttons, &QDialogButtonBox::accepted, &dlg, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dlg, &QDialog::reject);
+    form->addRow(buttons);
+    if (dlg.exec() != QDialog::Accepted) return;
+
+    PPIAnimationOptions opt;
+    opt.format = fmtBox->currentIndex() == 0 ? PPIAnimationOptions::Format_Gif : PPIAnimationOptions::Format_PngSequence;
+    QString path = opt.format == PPIAnimationOptions::Format_Gif
+                       ? QFileDialog::getSaveFileName(this, "保存动画", "playback.gif", "GIF (*.gif)")
+                       : QFileDialog::getExistingDirectory(this, "选择帧输出目录");
+    if (path.isEmpty()) return;
+
+    opt.image.size = QSize(sizeBox->value(), sizeBox->value());
+    opt.image.mode = m_currentMode;
+    opt.image.colors = m_ppi->colorMap();
+    opt.image.minDist = m_minDistBox->value();
+    opt.image.maxDist = m_maxDistBox->value();
+    opt.fps = fpsBox->value();
+    opt.raysPerFrame = stepBox->value();
+    opt.image.rayMask = m_manager.ppiRayMask();
+    ScanData data = m_manager.getScanData();
+
+    if (!m_animExport) {
+        m_animExport = new QFutureWatcher<int>(this);
+        connect(m_animExport, &QFutureWatcher<int>::finished, this, [this]() {
+            statusBar()->showMessage(QString("动画导出完成: %1 帧").arg(m_animExport->result()), 5000);
+        });
+    }
+    m_animExport->setFuture(QtConcurrent::run([this, data, path, opt]() {
+        return PPIExporter::exportAnimation(data, path, opt, [this](int done, int total) {
+            QMetaObject::invokeMethod(this, [this, done, total]() {
+                statusBar()->showMessage(QString("正在渲染动画 %1/%2 帧 ...").arg(done).arg(total));
+            }, Qt::QueuedConnection);
+        });
+    }));
+}
+
+void MainWindow::onPlaybackPosition(qint64 t) {
+    if (!m_timeSlider->isSliderDown()) {
+        QSignalBlocker block(m_timeSlider);
+        m_timeSlider->setValue(int((t - m_playback->startTime()) / 100));
+    }
+    m_timeLabel->setText(QDateTime::fromMSecsSinceEpoch(t).toString("yyyy-MM-dd HH:mm:ss"));
+}
+
+void MainWindow::onExportFrameTimes() {
+    QString p = QFileDialog::getSaveFileName(this, "保存帧时统计", "frametimes.csv", "CSV (*.csv)");
+    if (p.isEmpty()) return;
+    if (!m_ppi->exportFrameTimesCsv(p)) QMessageBox::warning(this, "错误", "无法写入文件: " + p);
+}
+
+void MainWindow::onRenderFallback(const QString &reason) {
+    QSignalBlocker block(m_glCheck);
+    m_glCheck->setChecked(false);
+    statusBar()->showMessage("OpenGL 不可用，已改用软件渲染: " + reason, 5000);
 }
 
 void MainWindow::onExportData() {
@@ -6,10 +6,19 @@
 #include <QComboBox>
 #include <QSpinBox>
 #include <QTimer>
+#include <QPushButton>
 #include <QLabel>
 #include <QSlider> // 【新增】
+#include <QCheckBox>
+#include <QFutureWatcher>
 #include "datamanager.h"
 #include "ppiwidget.h"
+#include "playbackengine.h"
+#include "ppimultiview.h"
+#include "timerangeview.h"
+#include "rhiwidget.h"
+#include "gateseriesview.h"
+#include "profileoverlay.h"
 #include "qcustomplot.h"
 
 class MainWindow : public QMainWindow {
@@ -22,23 +31,61 @@ private slots:
     void loadFiles();
     void updateFilter(double val);
     void updateLinePlot(int rayIndex);
+    void onRayHovered(int rayIndex);
+    void onOverlayChanged();
     void onModeChanged(int index);
     void onWindowSizeChanged(int val);
+    void onOutlierChanged(double val);
+    void onCompactToggled(bool on);
+    void onGLToggled(bool on);
+    void onPlotGLToggled(bool on);
+    void onBenchmarkPlots();
+    void onColorScaleChanged();
+    void onExportFrameTimes();
+    void onExportSweeps();
+    void onExportAnimation();
+    void onPlaybackPosition(qint64 t);
+    void onShowMultiView();
+    void onRenderFallback(const QString& reason);
     void onExportData();
     void onRangeChanged();
 
 private:
     void setupUi();
     void updateStatusBar();
+    void updateVadPlot(int rayIndex);
+    void showProfile(int rayIndex);
+    void updateOverlay(int rayIndex);
+    void fillProfile(QCPCurve* curve, const RadarRay& ray, bool snr, double& lo, double& hi);
+    void syncColorScaleBoxes();
+    void refreshViews(); // 数据处理参数变化后刷新所有 PPI
+    void rebuildPyramid(); // 后台重建时间金字塔
+    QList<QCustomPlot*> allPlots() const;
+    bool setPlotsOpenGl(bool on); // 返回实际是否用上了 OpenGL
 
     DataManager m_manager;
     PPIWidget *m_ppi;
+    RHIWidget *m_rhi;                    // 距离-高度剖面
+    PPIMultiView *m_multiView = nullptr; // 多视图对比窗口，按需创建
+    TimeRangeView *m_timeRange;          // 时间-距离热力图
+    GateSeriesView *m_gateSeries;        // 单个距离门的时间序列
     QCustomPlot *m_speedPlot;
     QCustomPlot *m_snrPlot;
 
     QDoubleSpinBox *m_snrBox;
     QComboBox *m_comboMode;
     QSpinBox *m_spinWinSize;
+    QDoubleSpinBox *m_outlierBox; // 野值修复阈值
+    QCheckBox *m_compactCheck;    // 紧凑存储模式
+    QCheckBox *m_glCheck;         // OpenGL 渲染 PPI
+    QCheckBox *m_plotGlCheck;     // QCustomPlot 图表用 OpenGL 绘图缓冲
+    QCheckBox *m_hudCheck;        // 性能叠加层
+    QCheckBox *m_hoverCheck;      // 廓线跟随鼠标
+    QCheckBox *m_overlayCheck;    // 叠画所在扫描的全部廓线
+    QDoubleSpinBox *m_overlayOffsetBox; // 瀑布图错开量
+    QComboBox *m_paletteBox;      // 色标
+    QDoubleSpinBox *m_scaleLoBox; // 色标值域
+    QDoubleSpinBox *m_scaleHiBox;
 
     // 【新增】距离控制相关
     QSlider *m_minSlider; // 最小距离滑条
@@ -49,11 +96,27 @@ private:
     QLabel *m_statusLabel;
     QString m_currentFileName = "未加载";
 
-    QTimer *m_playTimer;
-    int m_playIndex = 0;
+    QFutureWatcher<int> *m_sweepExport = nullptr; // 后台批量出图
+    QFutureWatcher<int> *m_animExport = nullptr;  // 后台动画导出
+    QFutureWatcher<TimePyramid> *m_pyramidBuild = nullptr; // 后台重建金字塔
+    bool m_pyramidPending = false; // 重建期间数据又变了，完成后再建一次
+
+    // 回放
+    PlaybackEngine *m_playback;
+    QPushButton *m_playBtn;
+    QComboBox *m_speedBox;
+    QSlider *m_timeSlider;
+    QLabel *m_timeLabel;
     DisplayMode m_currentMode = Mode_Speed;
     QCPCurve *m_speedCurve;
     QCPCurve *m_snrCurve;
+    int m_selectedRay = -1; // 点选的射线；悬停结束后廓线回到它
+    ProfileOverlay *m_overlay;
+
+    // VAD 风廓线
+    QCustomPlot *m_vadPlot;
+    QCPCurve *m_vadSpeedCurve;
+    QCPCurve *m_vadDirCurve;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,83 @@
+#include "playbackengine.h"
+#include <algorithm>
+#include <limits>
+
+PlaybackEngine::PlaybackEngine(QObject *parent) : QObject(parent) {
+    m_timer.setTimerType(Qt::PreciseTimer);
+    m_timer.setInterval(TickMs);
+    connect(&m_timer, &QTimer::timeout, this, &PlaybackEngine::tick);
+}
+
+void PlaybackEngine::setData(const ScanData &data) {
+    pause();
+    m_times.resize(data.size());
+    qint64 last = std::numeric_limits<qint64>::min();
+    for (int i = 0; i < data.size(); ++i) {
+        // 个别时间戳回跳时取前值，保证可以二分
+        last = std::max(last, data[i].timestamp.toMSecsSinceEpoch());
+        m_times[i] = last;
+    }
+    m_limit = -1;
+    setPosition(startTime());
+}
+
+int PlaybackEngine::rayCountAt(qint64 t) const {
+    return int(std::upper_bound(m_times.constBegin(), m_times.constEnd(), t) - m_times.constBegin());
+}
+
+void PlaybackEngine::play() {
+    if (m_times.isEmpty() || isPlaying()) return;
+    if (m_position >= endTime()) setPosition(startTime()); // 播完再按从头开始
+    m_dropped = 0;
+    reanchor();
+    m_timer.start();
+    emit stateChanged(true);
+}
+
+void PlaybackEngine::pause() {
+    if (!isPlaying()) return;
+    m_timer.stop();
+    emit stateChanged(false);
+}
+
+void PlaybackEngine::setSpeed(double speed) {
+    m_speed = std::clamp(speed, MinSpeed, MaxSpeed);
+    reanchor(); // 以当前位置重新计时，倍速切换时画面不跳
+}
+
+void PlaybackEngine::seek(qint64 t) {
+    if (m_times.isEmpty()) return;
+    setPosition(std::clamp(t, startTime(), endTime()));
+    reanchor();
+}
+
+void PlaybackEngine::seekRay(int limit) {
+    if (m_times.isEmpty()) return;
+    seek(m_times[std::clamp(limit, 1, int(m_times.size())) - 1]);
+}
+
+void PlaybackEngine::reanchor() {
+    m_anchor = m_position;
+    m_clock.start();
+    m_lastTick = 0;
+}
+
+void PlaybackEngine::tick() {
+    qint64 now = m_clock.elapsed();
+    // 节拍迟到（上一帧绘制太久）时不补帧，直接跳到时钟对应的位置，只记录跳过了几帧
+    m_dropped += int(std::max<qint64>(0, (now - m_lastTick) / TickMs - 1));
+    m_lastTick = now;
+
+    setPosition(std::min(endTime(), m_anchor + qint64(now * m_speed)));
+    if (m_position >= endTime()) pause();
+}
+
+void PlaybackEngine::setPosition(qint64 t) {
+    m_position = t;
+    emit positionChanged(t);
+    int n = rayCountAt(t);
+    if (n != m_limit) {
+        m_limit = n;
+        emit limitChanged(n);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef PLAYBACKENGINE_H
+#define PLAYBACKENGINE_H
+
+#include "datatypes.h"
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+// 按数据时间戳 + 墙钟驱动的回放：
+//  - 当前数据时间 = 锚点时间 + 墙钟流逝 × 倍速，与射线频率、绘制快慢无关
+//  - 每个节拍直接按时钟算出应到的位置，绘制跟不上时跳过中间帧而不是排队
+//  - 时间 -> 射线数用二分查找，跳转是 O(log n)
+class PlaybackEngine : public QObject
+{
+    Q_OBJECT
+public:
+    static constexpr int TickMs = 16;
+    static constexpr double MinSpeed = 1.0;
+    static constexpr double MaxSpeed = 1000.0;
+
+    explicit PlaybackEngine(QObject *parent = nullptr);
+
+    void setData(const ScanData& data); // 只保留时间戳
+
+    bool isPlaying() const { return m_timer.isActive(); }
+    double speed() const { return m_speed; }
+    qint64 startTime() const { return m_times.isEmpty() ? 0 : m_times.first(); }
+    qint64 endTime() const { return m_times.isEmpty() ? 0 : m_times.last(); }
+    qint64 position() const { return m_position; } // 当前数据时间 (ms since epoch)
+    int limit() const { return m_limit; }
+    int droppedFrames() const { return m_dropped; }
+
+    // 时间戳 <= t 的射线数
+    int rayCountAt(qint64 t) const;
+
+public slots:
+    void play();
+    void pause();
+    void toggle() { isPlaying() ? pause() : play(); }
+    void setSpeed(double speed);
+    void seek(qint64 t);
+    void seekRay(int limit);
+
+signals:
+    void limitChanged(int limit);
+    void positionChanged(qint64 t);
+    void stateChanged(bool playing);
+
+private:
+    void tick();
+    void setPosition(qint64 t);
+    void reanchor();
+
+    QVector<qint64> m_times; // 单调不减
+    QTimer m_timer;
+    QElapsedTimer m_clock;   // 自锚点起的墙钟
+    qint64 m_anchor = 0;     // 锚点处的数据时间
+    qint64 m_position = 0;
+    qint64 m_lastTick = 0;   // 上一节拍的墙钟 (ms)
+    double m_speed = 100.0;
+    int m_limit = 0;
+    int m_dropped = 0;
+};
+
+#endif // PLAYBACKENGINE_H
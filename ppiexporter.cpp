@@ -0,0 +1,236 @@
+#include "ppiexporter.h"
+#include "gifencoder.h"
+#include <QtConcurrent>
+#include <QThreadPool>
+#include <QThread>
+#include <QAtomicInt>
+#include <QDir>
+#include <QFile>
+#include <numeric>
+
+QString PPIExporter::sweepFileName(const ScanData &data, const SweepInfo &sweep, int sweepIndex) {
+    QString t = data.at(sweep.firstRay).timestamp.toString("yyyyMMdd_HHmmss");
+    return QString("sweep_%1_%2_el%3.png").arg(sweepIndex + 1, 3, 10, QChar('0')).arg(t)
+        .arg(sweep.elevation, 0, 'f', 1);
+}
+
+QImage PPIExporter::renderSweep(const ScanData &data, const SweepInfo &sweep, const PPIExportOptions &opt,
+                                PPIRenderer &renderer, int sweepIndex) {
+    PPIView v;
+    v.size = opt.size;
+    v.origin = QPointF(opt.size.width() / 2.0, opt.size.height() / 2.0);
+    v.pxPerM = qMin(opt.size.width(), opt.size.height()) / 2.2 / opt.rangeMeters;
+    v.mode = opt.mode;
+    v.colors = opt.colors;
+    v.minDist = opt.minDist;
+    v.maxDist = opt.maxDist;
+    v.rays = data;
+    v.begin = sweep.firstRay;
+    v.end = sweep.firstRay + sweep.rayCount;
+    v.rayMask = opt.rayMask;
+    QImage heat = renderer.render(v);
+
+    QImage out(opt.size, QImage::Format_ARGB32_Premultiplied);
+    out.fill(Qt::white);
+    QPainter p(&out);
+    p.setRenderHint(QPainter::Antialiasing);
+    p.drawImage(0, 0, heat);
+    if (opt.overlays) {
+        PPIRenderer::drawRangeRings(p, v.origin, v.pxPerM, opt.minDist, opt.maxDist);
+
+        QSize ls = PPIRenderer::legendSize();
+        p.save();
+        p.translate(out.width() - ls.width() - 20, out.height() - ls.height() - 20);
+        PPIRenderer::drawLegend(p, opt.colors, opt.mode);
+        p.restore();
+
+        p.setPen(Qt::black);
+        QString title = QString("%1   %2   仰角 %3°")
+                            .arg(sweepIndex >= 0 ? QString("扫描 %1").arg(sweepIndex + 1) : QString())
+                            .arg(data.at(sweep.firstRay).timestamp.toString("yyyy-MM-dd HH:mm:ss"))
+                            .arg(sweep.elevation, 0, 'f', 1);
+        p.drawText(20, 30, title.trimmed());
+    }
+    return out;
+}
+
+int PPIExporter::exportSweeps(const ScanData &data, const SweepList &sweeps, const QString &dir,
+                              const PPIExportOptions &opt, const ProgressCallback &progress) {
+    if (sweeps.isEmpty() || !QDir().mkpath(dir)) return 0;
+
+    QThreadPool pool;
+    const int threads = opt.threads > 0 ? opt.threads : QThread::idealThreadCount();
+    pool.setMaxThreadCount(threads);
+
+    // RHI 扫描不出 PPI 图
+    QVector<int> order;
+    for (int i = 0; i < sweeps.size(); ++i)
+        if (sweeps[i].type == Scan_PPI) order << i;
+    QAtomicInt done(0), written(0);
+    const int total = order.size();
+    if (total == 0) return 0;
+
+    // 每个线程一段、一个渲染器：各扫描图像几何相同，像素查找表只建一次。
+    // 隔行分段（第 c 段取 c, c + n, ...），各段扫描长短相近
+    const int chunkCount = qMin(total, threads);
+    QVector<int> chunks(chunkCount);
+    std::iota(chunks.begin(), chunks.end(), 0);
+
+    QtConcurrent::blockingMap(&pool, chunks, [&](int c) {
+        // 外层已经按 sweep 并行，图块不再开线程
+        PPIRenderer renderer(1);
+        for (int k = c; k < total; k += chunkCount) {
+            const int i = order[k];
+            QImage img = renderSweep(data, sweeps[i], opt, renderer, i);
+            if (img.save(QDir(dir).filePath(sweepFileName(data, sweeps[i], i)), "PNG")) written.fetchAndAddRelaxed(1);
+            int n = done.fetchAndAddRelaxed(1) + 1;
+            if (progress) progress(n, total);
+        }
+    });
+    return written.loadRelaxed();
+}
+
+// ---------------------------------------------------------
+// 【新增】回放动画导出
+// ---------------------------------------------------------
+static int animationStep(const PPIAnimationOptions &opt, int begin, int end) {
+    return opt.raysPerFrame > 0 ? opt.raysPerFrame : qMax(2, (end - begin) / 2000);
+}
+
+static void animationRange(const ScanData &data, const PPIAnimationOptions &opt, int &begin, int &end) {
+    begin = qBound(0, opt.begin, int(data.size()));
+    end = opt.end < 0 ? int(data.size()) : qBound(begin, opt.end, int(data.size()));
+}
+
+int PPIExporter::animationFrameCount(const ScanData &data, const PPIAnimationOptions &opt) {
+    int begin, end;
+    animationRange(data, opt, begin, end);
+    int step = animationStep(opt, begin, end);
+    return (end - begin + step - 1) / step;
+}
+
+// GIF 全局调色板：背景白、无效灰、叠加层用到的几种灰/黑，其余均匀取自色标（按 Alpha 混到白底上）
+static QVector<QRgb> animationPalette(const ColorMap &colors) {
+    QVector<QRgb> pal = { qRgb(255, 255, 255), qRgb(240, 240, 240), qRgb(0, 0, 0),
+                          qRgb(192, 192, 192), qRgb(160, 160, 164), qRgb(128, 128, 128), qRgb(64, 64, 64) };
+    const QVector<QRgb> &table = colors.table();
+    const int n = 256 - pal.size();
+    for (int i = 0; i < n; ++i) {
+        QRgb c = table[qRound(double(i) * (table.size() - 1) / (n - 1))];
+        int a = qAlpha(c);
+        auto over = [a](int v) { return (v * a + 255 * (255 - a)) / 255; };
+        pal << qRgb(over(qRed(c)), over(qGreen(c)), over(qBlue(c)));
+    }
+    return pal;
+}
+
+int PPIExporter::exportAnimation(const ScanData &data, const QString &path, const PPIAnimationOptions &opt,
+                                 const ProgressCallback &progress) {
+    int begin, end;
+    animationRange(data, opt, begin, end);
+    const int step = animationStep(opt, begin, end);
+    const int total = animationFrameCount(data, opt);
+    if (total <= 0) return 0;
+    const bool gif = opt.format == PPIAnimationOptions::Format_Gif;
+    if (!gif && !QDir().mkpath(path)) return 0;
+
+    const PPIExportOptions &img = opt.image;
+    PPIView base;
+    base.size = img.size;
+    base.origin = QPointF(img.size.width() / 2.0, img.size.height() / 2.0);
+    base.pxPerM = qMin(img.size.width(), img.size.height()) / 2.2 / img.rangeMeters;
+    base.mode = img.mode;
+    base.colors = img.colors;
+    base.minDist = img.minDist;
+    base.maxDist = img.maxDist;
+    base.rays = data;
+    base.begin = begin;
+    base.rayMask = img.rayMask;
+    auto frameEnd = [&](int f) { return qMin(end, begin + (f + 1) * step); };
+
+    // 刻度圈和图例每帧都一样，只画一次
+    QImage overlay;
+    if (img.overlays) {
+        overlay = QImage(img.size, QImage::Format_ARGB32_Premultiplied);
+        overlay.fill(Qt::transparent);
+        QPainter p(&overlay);
+        p.setRenderHint(QPainter::Antialiasing);
+        PPIRenderer::drawRangeRings(p, base.origin, base.pxPerM, img.minDist, img.maxDist);
+        QSize ls = PPIRenderer::legendSize();
+        p.translate(overlay.width() - ls.width() - 20, overlay.height() - ls.height() - 20);
+        PPIRenderer::drawLegend(p, img.colors, img.mode);
+    }
+
+    auto compose = [&](PPIRenderer &renderer, int f) {
+        PPIView v = base;
+        v.end = frameEnd(f);
+        QImage heat = renderer.render(v);
+        QImage out(img.size, QImage::Format_ARGB32_Premultiplied);
+        out.fill(Qt::white);
+        QPainter p(&out);
+        p.drawImage(0, 0, heat);
+        if (img.overlays) {
+            p.drawImage(0, 0, overlay);
+            p.setPen(Qt::black);
+            p.drawText(20, 30, data.at(v.end - 1).timestamp.toString("yyyy-MM-dd HH:mm:ss"));
+        }
+        p.end();
+        return out;
+    };
+
+    QVector<QRgb> palette;
+    QVector<uchar> quantizer;
+    QVector<QByteArray> gifFrames;
+    const int delayCs = qMax(2, qRound(100.0 / qMax(0.1, opt.fps)));
+    if (gif) {
+        palette = animationPalette(img.colors);
+        quantizer = GifEncoder::buildQuantizer(palette);
+        gifFrames.resize(total);
+    }
+
+    QThreadPool pool;
+    const int threads = img.threads > 0 ? img.threads : QThread::idealThreadCount();
+    pool.setMaxThreadCount(threads);
+
+    // 每段开头要整建一次网格，段数取线程数的两倍兼顾负载均衡
+    const int chunkCount = qMin(total, threads * 2);
+    QVector<QPair<int, int>> chunks;
+    for (int c = 0; c < chunkCount; ++c)
+        chunks << qMakePair(int(qint64(total) * c / chunkCount), int(qint64(total) * (c + 1) / chunkCount));
+
+    QAtomicInt done(0), written(0);
+    QtConcurrent::blockingMap(&pool, chunks, [&](const QPair<int, int> &chunk) {
+        PPIRenderer renderer(1);
+        QVector<uchar> prev, cur;
+        // GIF 只写与上一帧的差异，段首先补渲一次上一帧作为基准
+        if (gif && chunk.first > 0) GifEncoder::quantize(compose(renderer, chunk.first - 1), quantizer, prev);
+
+        for (int f = chunk.first; f < chunk.second; ++f) {
+            QImage frame = compose(renderer, f);
+            bool ok;
+            if (gif) {
+                GifEncoder::quantize(frame, quantizer, cur);
+                QRect rect = prev.isEmpty() ? frame.rect() : GifEncoder::diffRect(prev, cur, img.size);
+                if (rect.isEmpty()) rect = QRect(0, 0, 1, 1); // 画面没变也要占一帧时长
+                gifFrames[f] = GifEncoder::frame(cur.constData(), img.size.width(), rect, delayCs);
+                prev.swap(cur);
+                ok = true;
+            } else {
+                ok = frame.save(QDir(path).filePath(QString("frame_%1.png").arg(f + 1, 5, 10, QChar('0'))), "PNG");
+            }
+            if (ok) written.fetchAndAddRelaxed(1);
+            int n = done.fetchAndAddRelaxed(1) + 1;
+            if (progress) progress(n, total);
+        }
+    });
+
+    if (gif) {
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) return 0;
+        file.write(GifEncoder::header(img.size, palette));
+        for (const QByteArray &f : gifFrames) file.write(f);
+        file.write(GifEncoder::trailer());
+        if (!file.flush()) return 0;
+    }
+    return written.loadRelaxed();
+}
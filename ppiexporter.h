@@ -0,0 +1,60 @@
+#ifndef PPIEXPORTER_H
+#define PPIEXPORTER_H
+
+#include "datatypes.h"
+#include "colormap.h"
+#include "ppirenderer.h"
+#include <QImage>
+#include <functional>
+
+// 离线导出参数（与窗口无关）
+struct PPIExportOptions {
+    QSize size = QSize(2048, 2048);
+    DisplayMode mode = Mode_Speed;
+    ColorMap colors;
+    double minDist = 0.0;
+    double maxDist = 10000.0;
+    double rangeMeters = 4000.0; // 映射到图像半径 1/1.1 处的距离，与窗口默认比例一致
+    bool overlays = true;        // 刻度圈、图例、标题
+    int threads = 0;             // 并行导出的线程数，<=0 按核数
+    QVector<bool> rayMask;       // 只画为 true 的射线（混合扫描时排除 RHI），空表示全部
+};
+
+// 【新增】回放动画导出：按射线顺序逐帧展开。
+// 帧按射线数切，不按时间：界面回放是按墙钟时间推进的，两者的步长没有对应关系
+struct PPIAnimationOptions {
+    enum Format { Format_PngSequence, Format_Gif };
+    PPIExportOptions image;      // 分辨率、模式、色标、叠加层、线程数
+    Format format = Format_Gif;
+    double fps = 20.0;           // 只决定 GIF 的帧间延时；PNG 序列不带时间信息，此项无效
+    int raysPerFrame = 0;        // 每帧新增射线数，<=0 时取 max(2, N/2000)（约 2000 帧）
+    int begin = 0;
+    int end = -1;                // <0 为数据末尾
+};
+
+// 不依赖任何 QWidget 的 PPI 出图：直接画到 QImage，可在工作线程或无界面进程中使用。
+// 批量导出按 sweep 并行，每个任务使用自己的 PPIRenderer（图块单线程），互不加锁。
+class PPIExporter
+{
+public:
+    // 在工作线程中调用，done 为已完成张数
+    typedef std::function<void(int done, int total)> ProgressCallback;
+
+    static QImage renderSweep(const ScanData& data, const SweepInfo& sweep, const PPIExportOptions& opt,
+                              PPIRenderer& renderer, int sweepIndex = -1);
+
+    // 每个 sweep 一张 PNG，写入 dir；返回成功写出的张数
+    static int exportSweeps(const ScanData& data, const SweepList& sweeps, const QString& dir,
+                            const PPIExportOptions& opt, const ProgressCallback& progress = ProgressCallback());
+
+    static QString sweepFileName(const ScanData& data, const SweepInfo& sweep, int sweepIndex);
+
+    // 回放动画：PNG 序列时 path 为目录 (frame_00001.png ...)，GIF 时为文件；返回写出的帧数。
+    // 帧区间切成连续的若干段并行渲染，每段内 end 单调增长，PPIRenderer 只增量描新露出的射线，
+    // 总耗时与帧数成线性关系
+    static int exportAnimation(const ScanData& data, const QString& path, const PPIAnimationOptions& opt,
+                               const ProgressCallback& progress = ProgressCallback());
+    static int animationFrameCount(const ScanData& data, const PPIAnimationOptions& opt);
+};
+
+#endif // PPIEXPORTER_H
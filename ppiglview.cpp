@@ -0,0 +1,297 @@
+#include "ppiglview.h"
+#include "ppiwidget.h"
+#include "spatialindex.h"
+#include <QPainter>
+#include <QSurfaceFormat>
+#include <QOpenGLContext>
+#include <QVector2D>
+#include <QOpenGLPixelTransferOptions>
+#include <QElapsedTimer>
+#include <cmath>
+
+static const char *kVertexShader = R"(
+#version 330 core
+layout(location = 0) in vec2 aPos;
+out vec2 vPos;
+void main() {
+    vPos = aPos;
+    gl_Position = vec4(aPos, 0.0, 1.0);
+}
+)";
+
+// 与 PPIRenderer 的像素查找表一致：像素 -> (距离门, 方位分箱) -> 值 -> 色标
+static const char *kFragmentShader = R"(
+#version 330 core
+in vec2 vPos;
+out vec4 fragColor;
+
+uniform sampler2D uData;   // x: 方位分箱, y: 距离门; r=风速, g=湍流, b=状态(0无射线 1有效 2无效)
+uniform sampler1D uColors; // 当前模式的色标查找表
+uniform vec2 uViewport;    // 窗口大小 (逻辑像素)
+uniform vec2 uOrigin;      // 雷达中心 (逻辑像素)
+uniform float uPxPerM;
+uniform float uD0;         // 第一个距离门
+uniform float uDr;         // 门间距
+uniform float uGates;      // 可绘制门数
+uniform float uMinDist;
+uniform float uMaxDist;
+uniform int uMode;         // 0 风速, 1 湍流
+uniform float uLo;         // 色标值域
+uniform float uHi;
+
+void main() {
+    vec2 pix = vec2((vPos.x * 0.5 + 0.5) * uViewport.x, (0.5 - vPos.y * 0.5) * uViewport.y);
+    vec2 d = pix - uOrigin;
+    float r = length(d) / uPxPerM;
+
+    float g = floor((r - uD0) / uDr);
+    if (g < 0.0 || g >= uGates) discard;
+    float gateStart = uD0 + g * uDr;
+    if (gateStart < uMinDist || gateStart > uMaxDist) discard;
+
+    // 雷达0度 = 屏幕东偏南15度
+    float az = mod(degrees(atan(d.y, d.x)) - 15.0, 360.0);
+    vec4 cell = texture(uData, vec2(az / 360.0, (g + 0.5) / uGates));
+    if (cell.b < 0.5) discard;
+    if (cell.b > 1.5) { fragColor = vec4(240.0 / 255.0, 240.0 / 255.0, 240.0 / 255.0, 1.0); return; }
+
+    // 与 ColorMap::indexOf 一致：量化到最近的一级，不做插值
+    float v = (uMode == 1) ? cell.g : cell.r;
+    float n = float(textureSize(uColors, 0));
+    float i = floor(clamp((v - uLo) / (uHi - uLo), 0.0, 1.0) * (n - 1.0) + 0.5);
+    fragColor = texelFetch(uColors, int(i), 0);
+}
+)";
+
+PPIGLView::PPIGLView(PPIWidget *owner) : QOpenGLWidget(owner), m_owner(owner) {
+    QSurfaceFormat fmt = format();
+    fmt.setVersion(3, 3);
+    fmt.setProfile(QSurfaceFormat::CoreProfile);
+    setFormat(fmt);
+    // 交互仍由 PPIWidget 处理
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+}
+
+PPIGLView::~PPIGLView() {
+    if (!isValid()) return;
+    makeCurrent();
+    delete m_dataTex;
+    delete m_colorTex;
+    m_quad.destroy();
+    m_vao.destroy();
+    doneCurrent();
+}
+
+bool PPIGLView::supportsGeometry(const PPIView &view) {
+    if (view.begin >= view.end) return true;
+    const QVector<RangeGate> &gates = view.rays.at(view.begin).gates;
+    int n = gates.size();
+    if (n < 2) return true;
+    double d0 = gates.first().distance;
+    double dr = (gates.last().distance - d0) / (n - 1);
+    if (dr <= 0) return false;
+    for (int j = 1; j < n; ++j) {
+        if (std::abs(gates[j].distance - (d0 + j * dr)) > 0.01 * dr) return false;
+    }
+    return true;
+}
+
+void PPIGLView::setView(const PPIView &view) {
+    if (view.dataRevision != m_uploadedRevision || view.rays.constData() != m_uploadedData
+        || view.begin != m_uploadedBegin || view.end != m_uploadedEnd) {
+        m_dataDirty = true;
+    }
+    m_view = view;
+    update();
+}
+
+void PPIGLView::fail(const QString &reason) {
+    m_failed = true;
+    m_ready = false;
+    emit glFailed(reason);
+}
+
+void PPIGLView::initializeGL() {
+    initializeOpenGLFunctions();
+    QSurfaceFormat f = context()->format();
+    if (f.version() < qMakePair(3, 3)) {
+        fail(QString("OpenGL 版本过低: %1.%2").arg(f.majorVersion()).arg(f.minorVersion()));
+        return;
+    }
+    if (!m_program.addShaderFromSourceCode(QOpenGLShader::Vertex, kVertexShader)
+        || !m_program.addShaderFromSourceCode(QOpenGLShader::Fragment, kFragmentShader)
+        || !m_program.link()) {
+        fail("着色器编译失败: " + m_program.log());
+        return;
+    }
+
+    // 铺满窗口的矩形
+    static const GLfloat quad[] = { -1.f, -1.f, 1.f, -1.f, -1.f, 1.f, 1.f, 1.f };
+    m_vao.create();
+    m_vao.bind();
+    m_quad.create();
+    m_quad.bind();
+    m_quad.allocate(quad, sizeof(quad));
+    m_program.enableAttributeArray(0);
+    m_program.setAttributeBuffer(0, GL_FLOAT, 0, 2);
+    m_vao.release();
+    m_quad.release();
+
+    m_ready = true;
+}
+
+// 色标查找表直接上传，预先与白色背景混合
+void PPIGLView::uploadColorMap() {
+    const QVector<QRgb> &table = m_view.colors.table();
+    const int n = table.size();
+    QVector<uchar> rgba(n * 4);
+    for (int i = 0; i < n; ++i) {
+        QRgb c = table[i];
+        double a = qAlpha(c) / 255.0;
+        rgba[i*4 + 0] = uchar(qRound(qRed(c) * a + 255 * (1 - a)));
+        rgba[i*4 + 1] = uchar(qRound(qGreen(c) * a + 255 * (1 - a)));
+        rgba[i*4 + 2] = uchar(qRound(qBlue(c) * a + 255 * (1 - a)));
+        rgba[i*4 + 3] = 255;
+    }
+    if (!m_colorTex) {
+        m_colorTex = new QOpenGLTexture(QOpenGLTexture::Target1D);
+        m_colorTex->setFormat(QOpenGLTexture::RGBA8_UNorm);
+        m_colorTex->setSize(n);
+        m_colorTex->setMinMagFilters(QOpenGLTexture::Nearest, QOpenGLTexture::Nearest);
+        m_colorTex->setWrapMode(QOpenGLTexture::ClampToEdge);
+        m_colorTex->allocateStorage(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8);
+    }
+    m_colorTex->setData(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8, rgba.constData());
+    m_colorSerial = m_view.colors.serial();
+}
+
+// ---------------------------------------------------------
+// 数据纹理：与软件光栅化的极坐标网格相同，按绘制顺序写入，后画的射线覆盖先画的
+// ---------------------------------------------------------
+void PPIGLView::stampRays(int from, int to, int &binLo, int &binHi) {
+    const int bins = PPISpatialIndex::Bins;
+    const int span = int(std::ceil(PPISpatialIndex::RayWidth / PPISpatialIndex::BinWidth));
+    binLo = bins;
+    binHi = -1;
+    const bool masked = !m_view.rayMask.isEmpty();
+    for (int i = from; i < to; ++i) {
+        if (masked && !m_view.rayMask.at(i)) continue;
+        const RadarRay &ray = m_view.rays.at(i);
+        int n = std::min(m_gates, int(ray.gates.size()) - 1);
+        int b0 = int(std::floor(ray.azimuth / PPISpatialIndex::BinWidth));
+        for (int d = 0; d <= span; ++d) {
+            int b = ((b0 + d) % bins + bins) % bins;
+            if (!PPISpatialIndex::covers(ray.azimuth, (b + 0.5) * PPISpatialIndex::BinWidth)) continue;
+            binLo = std::min(binLo, b);
+            binHi = std::max(binHi, b);
+            for (int j = 0; j < n; ++j) {
+                const RangeGate &g = ray.gates[j];
+                float *c = m_texels.data() + (qsizetype(j) * bins + b) * 4;
+                c[0] = g.speed;
+                c[1] = g.turbulence;
+                c[2] = g.isValid ? 1.0f : 2.0f;
+            }
+        }
+    }
+}
+
+void PPIGLView::uploadData() {
+    const int bins = PPISpatialIndex::Bins;
+
+    // 播放前进：只补写新露出的射线，上传它们覆盖的那几列
+    if (m_dataTex && m_view.dataRevision == m_uploadedRevision && m_view.rays.constData() == m_uploadedData
+        && m_view.begin == m_uploadedBegin && m_view.end > m_uploadedEnd) {
+        int lo, hi;
+        stampRays(m_uploadedEnd, m_view.end, lo, hi);
+        m_uploadedEnd = m_view.end;
+        m_dataDirty = false;
+        if (hi < lo) return;
+        QOpenGLPixelTransferOptions opts;
+        opts.setRowLength(bins);
+        m_dataTex->setData(lo, 0, 0, hi - lo + 1, m_gates, 1, QOpenGLTexture::RGBA, QOpenGLTexture::Float32,
+                           m_texels.constData() + qsizetype(lo) * 4, &opts);
+        return;
+    }
+
+    m_dataDirty = false;
+    m_uploadedRevision = m_view.dataRevision;
+    m_uploadedData = m_view.rays.constData();
+    m_uploadedBegin = m_view.begin;
+    m_uploadedEnd = m_view.end;
+
+    int gates = 0;
+    if (m_view.begin < m_view.end) {
+        const QVector<RangeGate> &g = m_view.rays.at(m_view.begin).gates;
+        gates = std::max(0, int(g.size()) - 1);
+        if (gates > 0) {
+            m_d0 = g.first().distance;
+            m_dr = (g.last().distance - m_d0) / gates;
+        }
+    }
+
+    if (gates != m_gates || !m_dataTex) {
+        delete m_dataTex;
+        m_dataTex = nullptr;
+        m_gates = gates;
+        if (gates == 0) return;
+        m_dataTex = new QOpenGLTexture(QOpenGLTexture::Target2D);
+        m_dataTex->setFormat(QOpenGLTexture::RGBA32F);
+        m_dataTex->setSize(bins, gates);
+        m_dataTex->setMinMagFilters(QOpenGLTexture::Nearest, QOpenGLTexture::Nearest);
+        m_dataTex->setWrapMode(QOpenGLTexture::DirectionS, QOpenGLTexture::Repeat);
+        m_dataTex->setWrapMode(QOpenGLTexture::DirectionT, QOpenGLTexture::ClampToEdge);
+        m_dataTex->allocateStorage(QOpenGLTexture::RGBA, QOpenGLTexture::Float32);
+    }
+
+    m_texels.fill(0.0f, qsizetype(bins) * gates * 4);
+    int lo, hi;
+    stampRays(m_view.begin, m_view.end, lo, hi);
+    m_dataTex->setData(QOpenGLTexture::RGBA, QOpenGLTexture::Float32, m_texels.constData());
+}
+
+void PPIGLView::paintGL() {
+    // 只计 CPU 侧的提交时间（含纹理上传），不等待 GPU 完成
+    QElapsedTimer frameClock;
+    frameClock.start();
+    bool uploaded = false;
+
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    if (m_ready) {
+        if (m_dataDirty) { uploadData(); uploaded = true; }
+        if (m_colorSerial != m_view.colors.serial()) { uploadColorMap(); uploaded = true; }
+        if (m_dataTex && m_gates > 0) {
+            bool turb = (m_view.mode == Mode_Turbulence);
+            m_program.bind();
+            m_dataTex->bind(0);
+            m_colorTex->bind(1);
+            m_program.setUniformValue("uData", 0);
+            m_program.setUniformValue("uColors", 1);
+            m_program.setUniformValue("uViewport", QVector2D(width(), height()));
+            m_program.setUniformValue("uOrigin", QVector2D(m_view.origin));
+            m_program.setUniformValue("uPxPerM", GLfloat(m_view.pxPerM));
+            m_program.setUniformValue("uD0", GLfloat(m_d0));
+            m_program.setUniformValue("uDr", GLfloat(m_dr));
+            m_program.setUniformValue("uGates", GLfloat(m_gates));
+            m_program.setUniformValue("uMinDist", GLfloat(m_view.minDist));
+            m_program.setUniformValue("uMaxDist", GLfloat(m_view.maxDist));
+            m_program.setUniformValue("uMode", turb ? 1 : 0);
+            m_program.setUniformValue("uLo", GLfloat(m_view.colors.lo()));
+            m_program.setUniformValue("uHi", GLfloat(m_view.colors.hi()));
+
+            m_vao.bind();
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            m_vao.release();
+            m_colorTex->release(1);
+            m_dataTex->release(0);
+            m_program.release();
+        }
+    }
+
+    // 叠加层（刻度圈、图例等）与软件渲染共用同一套绘制代码
+    QPainter p(this);
+    m_owner->drawOverlays(p);
+    p.end();
+    m_owner->recordFrame(frameClock.nsecsElapsed() / 1e6, !uploaded);
+}
@@ -0,0 +1,72 @@
+#ifndef PPIGLVIEW_H
+#define PPIGLVIEW_H
+
+#include <QOpenGLWidget>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLBuffer>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLTexture>
+#include "ppirenderer.h"
+
+class PPIWidget;
+
+// OpenGL 版 PPI 热力图：
+//  - 射线数据上传为一张 2D 纹理 (方位分箱 × 距离门)，RGBA = (风速, 湍流, 状态, -)
+//  - 色标查找表上传为 1D 纹理，色标/值域变化时重传
+//  - 极坐标变换、距离范围裁剪、取色全部在片元着色器里完成，
+//    平移/缩放/模式/距离范围变化只改 uniform，不占 CPU
+// 作为 PPIWidget 的子控件铺满父窗口，鼠标事件透传给父窗口；叠加层由父窗口用 QPainter 画。
+// 需要 OpenGL 3.3 Core（Mesa llvmpipe 软件实现也满足）。
+class PPIGLView : public QOpenGLWidget, protected QOpenGLFunctions
+{
+    Q_OBJECT
+public:
+    explicit PPIGLView(PPIWidget *owner);
+    ~PPIGLView();
+
+    // 视图参数；只有射线内容变化时才重新上传数据纹理
+    void setView(const PPIView& view);
+
+    bool isReady() const { return m_ready; }
+    bool hasFailed() const { return m_failed; }
+
+    // 距离门不等间距时着色器无法直接换算门号，需要退回软件渲染
+    static bool supportsGeometry(const PPIView& view);
+
+signals:
+    void glFailed(const QString& reason);
+
+protected:
+    void initializeGL() override;
+    void paintGL() override;
+
+private:
+    void fail(const QString& reason);
+    void uploadData();
+    void stampRays(int from, int to, int& binLo, int& binHi);
+    void uploadColorMap();
+
+    PPIWidget *m_owner;
+    PPIView m_view;
+    bool m_dataDirty = true;
+    quint64 m_uploadedRevision = ~0ull;
+    const RadarRay* m_uploadedData = nullptr;
+    int m_uploadedBegin = -1, m_uploadedEnd = -1;
+
+    bool m_ready = false;
+    bool m_failed = false;
+    QOpenGLShaderProgram m_program;
+    QOpenGLBuffer m_quad;
+    QOpenGLVertexArrayObject m_vao;
+    QOpenGLTexture* m_dataTex = nullptr;
+    QVector<float> m_texels; // 数据纹理的内存副本，播放时只补写新射线再局部上传
+    QOpenGLTexture* m_colorTex = nullptr;
+    quint64 m_colorSerial = 0;
+
+    // 距离门几何（等间距）
+    int m_gates = 0;
+    double m_d0 = 0.0, m_dr = 1.0;
+};
+
+#endif // PPIGLVIEW_H
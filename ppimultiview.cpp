@@ -0,0 +1,217 @@
+#include "ppimultiview.h"
+#include <QGridLayout>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QSpinBox>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QSignalBlocker>
+#include <QtMath>
+
+PPIMultiView::PPIMultiView(QWidget *parent) : QWidget(parent) {
+    m_geometry.reset(new PPIGeometryCache(MaxViews));
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(4, 4, 4, 4);
+
+    QHBoxLayout *bar = new QHBoxLayout;
+    m_countBox = new QSpinBox; m_countBox->setRange(1, MaxViews); m_countBox->setValue(4);
+    m_bindBox = new QComboBox; m_bindBox->addItems({ "按扫描", "按时间窗" });
+    m_firstBox = new QSpinBox; m_firstBox->setRange(1, 1);
+    m_windowBox = new QSpinBox; m_windowBox->setRange(1, 24 * 60); m_windowBox->setValue(m_windowMinutes);
+    m_windowBox->setSuffix(" min"); m_windowBox->setEnabled(false);
+    m_linkCheck = new QCheckBox("联动平移缩放"); m_linkCheck->setChecked(m_linked);
+    bar->addWidget(new QLabel("视图数:")); bar->addWidget(m_countBox);
+    bar->addWidget(new QLabel("绑定:")); bar->addWidget(m_bindBox);
+    bar->addWidget(new QLabel("起始:")); bar->addWidget(m_firstBox);
+    bar->addWidget(new QLabel("窗长:")); bar->addWidget(m_windowBox);
+    bar->addWidget(m_linkCheck);
+    bar->addStretch();
+    layout->addLayout(bar);
+
+    m_grid = new QGridLayout;
+    m_grid->setSpacing(4);
+    layout->addLayout(m_grid, 1);
+
+    connect(m_countBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &PPIMultiView::setViewCount);
+    connect(m_bindBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &PPIMultiView::setBinding);
+    connect(m_firstBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int v) { setFirstSweep(v - 1); });
+    connect(m_windowBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &PPIMultiView::setWindowMinutes);
+    connect(m_linkCheck, &QCheckBox::toggled, this, &PPIMultiView::setLinked);
+
+    setViewCount(m_countBox->value());
+}
+
+void PPIMultiView::setData(const ScanData *data, const SweepList *sweeps, const PPISpatialIndex *index,
+                           const TimePyramid *pyramid, const QVector<bool> *mask) {
+    m_data = data;
+    m_sweeps = sweeps;
+    m_index = index;
+    m_pyramid = pyramid;
+    m_rayMask = mask;
+    m_ppiSweeps.clear();
+    if (sweeps) {
+        for (int i = 0; i < sweeps->size(); ++i)
+            if (sweeps->at(i).type != Scan_RHI) m_ppiSweeps << i;
+    }
+    m_geometry->clear();
+    for (PPIWidget *v : m_views) {
+        v->setData(data);
+        v->setSpatialIndex(index);
+        v->setPyramid(pyramid);
+        v->setRayMask(mask);
+    }
+    bindViews();
+}
+
+void PPIMultiView::setDisplayMode(DisplayMode mode, const ColorMap &colors) {
+    m_mode = mode;
+    m_colors[mode == Mode_Turbulence ? 1 : 0] = colors;
+    for (PPIWidget *v : m_views) {
+        v->setDisplayMode(mode);
+        v->setColorMap(mode, colors); // 切模式后再换上共用的表
+    }
+}
+
+void PPIMultiView::setColorMap(DisplayMode mode, const ColorMap &colors) {
+    m_colors[mode == Mode_Turbulence ? 1 : 0] = colors;
+    for (PPIWidget *v : m_views) v->setColorMap(mode, colors);
+}
+
+void PPIMultiView::setDistanceRange(double min, double max) {
+    m_minDist = min;
+    m_maxDist = max;
+    for (PPIWidget *v : m_views) v->setDistanceRange(min, max);
+}
+
+void PPIMultiView::refresh() {
+    for (PPIWidget *v : m_views) v->refresh();
+}
+
+void PPIMultiView::pyramidUpdated() {
+    for (PPIWidget *v : m_views) v->pyramidUpdated();
+}
+
+void PPIMultiView::setViewCount(int n) {
+    n = qBound(1, n, MaxViews);
+    if (n == m_views.size()) return;
+    rebuildViews();
+    while (m_views.size() > n) {
+        delete m_titles.takeLast()->parentWidget(); // 连同标题一起删掉整个格子
+        m_views.removeLast();
+    }
+    while (m_views.size() < n) {
+        QWidget *cell = new QWidget;
+        QVBoxLayout *cl = new QVBoxLayout(cell);
+        cl->setContentsMargins(0, 0, 0, 0);
+        cl->setSpacing(0);
+        QLabel *title = new QLabel;
+        title->setAlignment(Qt::AlignCenter);
+        PPIWidget *v = new PPIWidget;
+        v->setGeometryCache(m_geometry);
+        v->setDisplayMode(m_mode);
+        v->setColorMap(Mode_Speed, m_colors[0]);
+        v->setColorMap(Mode_Turbulence, m_colors[1]);
+        v->setDistanceRange(m_minDist, m_maxDist);
+        v->setSpatialIndex(m_index);
+        v->setPyramid(m_pyramid);
+        v->setRayMask(m_rayMask);
+        v->setData(m_data);
+        if (!m_views.isEmpty()) v->setViewTransform(m_views[0]->viewScale(), m_views[0]->viewOffset());
+        connect(v, &PPIWidget::raySelected, this, &PPIMultiView::raySelected);
+        connect(v, &PPIWidget::viewTransformChanged, this, [this, v](double scale, const QPointF &offset) {
+            syncTransform(v, scale, offset);
+        });
+        cl->addWidget(title);
+        cl->addWidget(v, 1);
+        m_views << v;
+        m_titles << title;
+    }
+
+    // 重新排成接近正方形的网格，各行各列等分，格子尽量一样大好共用查找表
+    const int cols = qCeil(qSqrt(n));
+    for (int i = 0; i < m_views.size(); ++i) m_grid->addWidget(m_titles[i]->parentWidget(), i / cols, i % cols);
+    for (int c = 0; c < MaxViews; ++c) m_grid->setColumnStretch(c, c < cols ? 1 : 0);
+    for (int r = 0; r < MaxViews; ++r) m_grid->setRowStretch(r, r < (n + cols - 1) / cols ? 1 : 0);
+    bindViews();
+}
+
+// 先把格子从网格里摘出来，再按新的列数重新放
+void PPIMultiView::rebuildViews() {
+    for (QLabel *t : m_titles) m_grid->removeWidget(t->parentWidget());
+}
+
+void PPIMultiView::setBinding(int binding) {
+    m_binding = Binding(binding);
+    m_windowBox->setEnabled(m_binding == Bind_TimeWindow);
+    bindViews();
+}
+
+void PPIMultiView::setFirstSweep(int sweep) {
+    m_firstSweep = qMax(0, sweep);
+    bindViews();
+}
+
+void PPIMultiView::setWindowMinutes(int minutes) {
+    m_windowMinutes = qMax(1, minutes);
+    bindViews();
+}
+
+void PPIMultiView::setLinked(bool on) {
+    m_linked = on;
+    if (on && !m_views.isEmpty()) syncTransform(m_views[0], m_views[0]->viewScale(), m_views[0]->viewOffset());
+}
+
+void PPIMultiView::syncTransform(PPIWidget *source, double scale, const QPointF &offset) {
+    if (!m_linked) return;
+    for (PPIWidget *v : m_views)
+        if (v != source) v->setViewTransform(scale, offset, true);
+}
+
+void PPIMultiView::bindViews() {
+    const bool ready = m_data && !m_data->isEmpty();
+    const int sweepCount = m_ppiSweeps.size();
+    const qint64 windowMs = qint64(m_windowMinutes) * 60 * 1000;
+    const QDateTime t0 = ready ? m_data->first().timestamp : QDateTime();
+    {
+        // 起始序号的上限随绑定方式变化
+        QSignalBlocker block(m_firstBox);
+        int maxFirst = 1;
+        if (m_binding == Bind_Sweep) maxFirst = qMax(1, sweepCount);
+        else if (ready) maxFirst = int(qMax<qint64>(1, (t0.msecsTo(m_data->last().timestamp) + windowMs) / windowMs));
+        // 越界的起始序号（外部调用或换了绑定方式）收回范围内，下面各视图也按收回后的值取
+        m_firstSweep = qBound(0, m_firstSweep, maxFirst - 1);
+        m_firstBox->setRange(1, maxFirst);
+        m_firstBox->setValue(m_firstSweep + 1);
+    }
+
+    for (int i = 0; i < m_views.size(); ++i) {
+        PPIWidget *v = m_views[i];
+        QLabel *title = m_titles[i];
+        const int k = m_firstSweep + i;
+        if (!ready) {
+            title->setText("未加载");
+            continue;
+        }
+        if (m_binding == Bind_Sweep) {
+            v->setTimeWindow(QDateTime(), QDateTime());
+            if (k < sweepCount) {
+                const int si = m_ppiSweeps[k];
+                const SweepInfo &s = m_sweeps->at(si);
+                v->setRayRange(s.firstRay, s.firstRay + s.rayCount);
+                title->setText(QString("扫描 %1   %2   仰角 %3°").arg(si + 1)
+                                   .arg(m_data->at(s.firstRay).timestamp.toString("HH:mm:ss"))
+                                   .arg(s.elevation, 0, 'f', 1));
+            } else {
+                v->setRayRange(0, 0);
+                title->setText("—");
+            }
+        } else {
+            QDateTime from = t0.addMSecs(windowMs * k), to = from.addMSecs(windowMs);
+            v->setRayRange(-1, -1);
+            v->setTimeWindow(from, to);
+            title->setText(QString("%1 ~ %2").arg(from.toString("MM-dd HH:mm")).arg(to.toString("HH:mm")));
+        }
+    }
+}
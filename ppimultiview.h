@@ -0,0 +1,83 @@
+#ifndef PPIMULTIVIEW_H
+#define PPIMULTIVIEW_H
+
+#include <QWidget>
+#include <QVector>
+#include <QSharedPointer>
+#include "ppiwidget.h"
+
+class QGridLayout;
+class QLabel;
+class QSpinBox;
+class QComboBox;
+class QCheckBox;
+
+// 小多图：N 个 PPIWidget 并排，各自绑定一个扫描或一个时间窗，用来对比相邻扫描。
+//  - 数据只有一份：各视图拿的是同一个 ScanData / 空间索引 / 金字塔的指针
+//  - 色标查找表建一次，按值发给每个视图（隐式共享同一块表）
+//  - 像素查找表经 PPIGeometryCache 共用：格子尺寸相同、联动缩放时只建一次
+class PPIMultiView : public QWidget
+{
+    Q_OBJECT
+public:
+    enum Binding { Bind_Sweep, Bind_TimeWindow };
+    static constexpr int MaxViews = 9;
+
+    explicit PPIMultiView(QWidget *parent = nullptr);
+
+    // mask 为每条射线是否属于 PPI 扫描（可为空），"按扫描" 绑定时也只列 PPI 扫描
+    void setData(const ScanData* data, const SweepList* sweeps, const PPISpatialIndex* index,
+                 const TimePyramid* pyramid, const QVector<bool>* mask);
+    void setDisplayMode(DisplayMode mode, const ColorMap& colors);
+    void setColorMap(DisplayMode mode, const ColorMap& colors);
+    void setDistanceRange(double min, double max);
+    void refresh(); // 过滤/湍流参数变了
+    void pyramidUpdated();
+
+    int viewCount() const { return m_views.size(); }
+    PPIWidget* view(int i) const { return m_views.value(i); }
+
+public slots:
+    void setViewCount(int n);
+    void setBinding(int binding);
+    void setFirstSweep(int sweep);        // 视图 i 显示第 sweep + i 个扫描
+    void setWindowMinutes(int minutes);   // 时间窗模式下每个视图的窗口长度
+    void setLinked(bool on);
+
+signals:
+    void raySelected(int rayIndex);
+
+private:
+    void rebuildViews();
+    void bindViews(); // 按当前绑定方式给每个视图分配射线范围
+    void syncTransform(PPIWidget* source, double scale, const QPointF& offset);
+
+    const ScanData* m_data = nullptr;
+    const SweepList* m_sweeps = nullptr;
+    const PPISpatialIndex* m_index = nullptr;
+    const TimePyramid* m_pyramid = nullptr;
+    const QVector<bool>* m_rayMask = nullptr;
+    QVector<int> m_ppiSweeps; // "按扫描" 可选的扫描（跳过 RHI）
+
+    DisplayMode m_mode = Mode_Speed;
+    ColorMap m_colors[2] = { ColorMap(Mode_Speed), ColorMap(Mode_Turbulence) };
+    double m_minDist = 0.0, m_maxDist = 10000.0;
+    QSharedPointer<PPIGeometryCache> m_geometry;
+
+    Binding m_binding = Bind_Sweep;
+    int m_firstSweep = 0;
+    int m_windowMinutes = 10;
+    bool m_linked = true;
+
+    QGridLayout* m_grid;
+    QVector<PPIWidget*> m_views;
+    QVector<QLabel*> m_titles;
+
+    QSpinBox* m_countBox;
+    QComboBox* m_bindBox;
+    QSpinBox* m_firstBox;
+    QSpinBox* m_windowBox;
+    QCheckBox* m_linkCheck;
+};
+
+#endif // PPIMULTIVIEW_H
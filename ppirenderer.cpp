@@ -0,0 +1,506 @@
+#include "ppirenderer.h"
+#include "spatialindex.h"
+#include <QtMath>
+#include <QtConcurrent>
+#include <QThread>
+#include <QPolygonF>
+#include <QElapsedTimer>
+#include <cmath>
+#include <algorithm>
+
+PPIRenderer::PPIRenderer(int tileThreads) {
+    // 默认留一个核给界面线程
+    m_tilePool.setMaxThreadCount(tileThreads > 0 ? tileThreads : qMax(1, QThread::idealThreadCount() - 1));
+}
+
+// 距离刻度圈：1000~4000 m，只画在显示范围内的圈
+void PPIRenderer::drawRangeRings(QPainter &p, const QPointF &center, double pxPerM, double minDist, double maxDist) {
+    p.setPen(QPen(Qt::lightGray, 1, Qt::DashLine));
+    p.setBrush(Qt::NoBrush);
+    for (int r = 1000; r <= 4000; r += 1000) {
+        if (r >= minDist && r <= maxDist) {
+            double radius = r * pxPerM;
+            p.drawEllipse(center, radius, radius);
+            p.drawText(center + QPointF(radius + 5, 0), QString::number(r) + "m");
+        }
+    }
+}
+
+QSize PPIRenderer::legendSize() {
+    return QSize(15 + 60, 160 + 40);
+}
+
+void PPIRenderer::drawLegend(QPainter &p, const ColorMap &colors, DisplayMode mode) {
+    int w = 15, h = 160;
+    QRect r(10, 30, w, h);
+
+    p.setPen(Qt::NoPen);
+    p.setBrush(QColor(255, 255, 255, 220));
+    p.drawRect(r.adjusted(-10, -30, 50, 10));
+
+    // 色条直接取查找表，拼成一列像素再拉伸
+    QImage bar(1, h, QImage::Format_ARGB32);
+    for (int i = 0; i < h; ++i) {
+        double v = colors.hi() - (colors.hi() - colors.lo()) * i / h;
+        bar.setPixel(0, i, colors.color(v));
+    }
+    p.drawImage(QRect(r.left(), r.top(), r.width(), h), bar);
+    p.setPen(Qt::black);
+    p.setBrush(Qt::NoBrush);
+    p.drawRect(r);
+    int prec = (mode == Mode_Turbulence) ? 2 : 1;
+    p.drawText(r.right() + 5, r.top() + 10, QString::number(colors.hi(), 'f', prec));
+    p.drawText(r.right() + 5, r.bottom(), QString::number(colors.lo(), 'f', prec));
+    p.drawText(r.left() - 5, r.top() - 10, (mode == Mode_Turbulence ? "湍流" : "风速"));
+}
+
+// 距离 -> 门号：等间距时直接计算，否则二分查找
+int PPIRenderer::gateOf(double distance) const {
+    if (m_uniform) return std::min(m_gates - 1, int((distance - m_d0) / m_dr));
+    auto it = std::upper_bound(m_edges.begin(), m_edges.end(), float(distance));
+    return int(it - m_edges.begin()) - 1;
+}
+
+// ---------------------------------------------------------
+// 视口裁剪：图像矩形在极坐标下覆盖的距离范围与方位分箱
+// ---------------------------------------------------------
+PPIRenderer::CullWindow PPIRenderer::cullFor(const PPIView &view) {
+    const int bins = PPISpatialIndex::Bins;
+    CullWindow c;
+    // 换算回全分辨率几何（草图画布是缩小的）
+    const double s = view.lodScale;
+    const double pxPerM = view.pxPerM * s;
+    QRectF rect(QPointF(0, 0), QSizeF(view.size) * s);
+    const QPointF o = view.origin * s;
+    const QPointF corners[4] = { rect.topLeft(), rect.topRight(), rect.bottomLeft(), rect.bottomRight() };
+
+    double rMax = 0;
+    for (const QPointF &p : corners) rMax = std::max(rMax, std::hypot(p.x() - o.x(), p.y() - o.y()));
+    c.rHi = rMax / pxPerM;
+
+    if (rect.contains(o)) {
+        c.rLo = 0.0;
+        c.bins.fill(true, bins);
+        return c;
+    }
+    // 雷达中心在图外：最近距离取矩形上离中心最近的点，方位只取四角张成的扇区
+    QPointF nearest(qBound(rect.left(), o.x(), rect.right()), qBound(rect.top(), o.y(), rect.bottom()));
+    c.rLo = std::hypot(nearest.x() - o.x(), nearest.y() - o.y()) / pxPerM;
+
+    QPointF mid = rect.center() - o;
+    double ref = qRadiansToDegrees(std::atan2(mid.y(), mid.x()));
+    double lo = 0, hi = 0;
+    for (const QPointF &p : corners) {
+        double a = qRadiansToDegrees(std::atan2(p.y() - o.y(), p.x() - o.x())) - ref;
+        while (a > 180) a -= 360;
+        while (a <= -180) a += 360;
+        lo = std::min(lo, a);
+        hi = std::max(hi, a);
+    }
+    // 屏幕角 = 方位 + 15，两端各多留一个分箱
+    int b0 = int(std::floor((ref + lo - 15.0) / PPISpatialIndex::BinWidth)) - 1;
+    int b1 = int(std::ceil((ref + hi - 15.0) / PPISpatialIndex::BinWidth)) + 1;
+    c.bins.fill(false, bins);
+    for (int b = b0; b <= b1; ++b) c.bins[((b % bins) + bins) % bins] = true;
+    return c;
+}
+
+bool PPIRenderer::CullWindow::contains(const CullWindow &o) const {
+    if (bins.size() != o.bins.size() || o.rLo < rLo || o.rHi > rHi) return false;
+    for (int b = 0; b < bins.size(); ++b)
+        if (o.bins[b] && !bins[b]) return false;
+    return true;
+}
+
+// 细节层次：一个距离门 / 一个方位分箱在屏幕上不足一个像素时，按 2 的幂合并
+void PPIRenderer::chooseLod(const PPIView &view, int &gateStride, int &binStride) {
+    gateStride = binStride = 1;
+    if (view.begin >= view.end) return;
+    const QVector<RangeGate> &g = view.rays.at(view.begin).gates;
+    if (g.size() < 2) return;
+    const double pxPerM = view.pxPerM * view.lodScale;
+    double gatePx = (g.last().distance - g.first().distance) / (g.size() - 1) * pxPerM;
+    while (gatePx * gateStride < 1.0 && gateStride < MaxGateStride) gateStride *= 2;
+    double arcPx = g.last().distance * pxPerM * qDegreesToRadians(PPISpatialIndex::BinWidth);
+    while (arcPx * binStride < 1.0 && binStride < MaxBinStride) binStride *= 2;
+}
+
+// ---------------------------------------------------------
+// 极坐标网格：按绘制顺序把每条射线写进它覆盖的方位分箱
+// ---------------------------------------------------------
+void PPIRenderer::buildGrid(const PPIView &view) {
+    m_edges.clear();
+    m_gates = 0;
+    if (view.begin < view.end) {
+        for (const auto &g : view.rays.at(view.begin).gates) m_edges << g.distance;
+    }
+    m_gates = std::max(0, int(m_edges.size()) - 1);
+    m_uniform = false;
+    if (m_gates > 0) {
+        m_d0 = m_edges.first();
+        m_dr = (m_edges.last() - m_d0) / m_gates;
+        m_uniform = m_dr > 0;
+        for (int j = 1; j < m_edges.size() && m_uniform; ++j) {
+            if (std::abs(m_edges[j] - (m_d0 + j * m_dr)) > 0.01 * m_dr) m_uniform = false;
+        }
+    }
+
+    const int bins = PPISpatialIndex::Bins;
+    m_cols = (m_gates + m_gateStride - 1) / m_gateStride;
+    m_grid.fill(0, 1 + (bins / m_binStride) * m_cols);
+    m_canvasStamp = 0; // 网格整体重建，旧画布作废
+    m_dirtyBins.fill(false, bins);
+    m_hasDirty = false;
+    if (m_gates == 0) return;
+
+    stampRays(view, view.begin, view.end, false);
+}
+
+// 把 [from, to) 的射线依次写进网格；markDirty 时记下被改写的分箱，供增量重填
+// 只处理视口内的分箱与门列；合并的门列取其中已绘制有效门的均值
+void PPIRenderer::stampRays(const PPIView &view, int from, int to, bool markDirty) {
+    const int bins = PPISpatialIndex::Bins;
+    const QRgb invalid = qRgb(240, 240, 240); // 无效数据画浅灰
+    const int span = int(std::ceil(PPISpatialIndex::RayWidth / PPISpatialIndex::BinWidth));
+    const int k = m_gateStride;
+    const bool turb = (view.mode == Mode_Turbulence);
+
+    // 可见的门列范围
+    int cLo = (m_cull.rLo <= m_edges.first()) ? 0 : std::max(0, gateOf(m_cull.rLo)) / k;
+    int cHi = (m_cull.rHi >= m_edges.last()) ? m_cols - 1 : std::max(0, gateOf(m_cull.rHi)) / k;
+    if (cLo > cHi) return;
+
+    // 分段计时要在每条射线上取三次时间，并把取色拆成单独一遍；只在性能叠加层打开时这样做，
+    // 平时取色并在遍历里，整段只计一次时间
+    const bool timed = m_detailedTiming;
+    QVector<QRgb> rowColors(m_cols);
+    QVector<bool> rowDrawn(m_cols);
+    QVector<double> rowValues(timed ? m_cols : 0);
+    QVector<bool> rowValid(timed ? m_cols : 0);
+
+    QElapsedTimer clock;
+    clock.start();
+    qint64 tTraverse = 0, tColor = 0, tRaster = 0;
+    qint64 t0 = 0, t1 = 0, t2 = 0;
+
+    const bool masked = !view.rayMask.isEmpty();
+    for (int i = from; i < to; ++i) {
+        if (masked && !view.rayMask.at(i)) continue;
+        if (timed) t0 = clock.nsecsElapsed();
+        const RadarRay &ray = view.rays.at(i);
+        double az = ray.azimuth;
+        int b0 = int(std::floor(az / PPISpatialIndex::BinWidth));
+        int n = std::min(m_gates, int(ray.gates.size()) - 1);
+
+        // 扇区完全在视口外的射线直接跳过
+        bool visible = false;
+        for (int d = 0; d <= span && !visible; ++d) visible = m_cull.bins[((b0 + d) % bins + bins) % bins];
+        if (!visible) {
+            m_stats.raysCulled++;
+            m_stats.gatesCulled += std::max(0, n);
+            if (timed) tTraverse += clock.nsecsElapsed() - t0;
+            continue;
+        }
+
+        int cEnd = std::min(cHi, (n - 1) / k);
+        int used = std::max(0, std::min(n, (cEnd + 1) * k) - cLo * k);
+        m_stats.raysStamped++;
+        m_stats.gatesCulled += std::max(0, n) - used;
+        m_stats.gatesMerged += used - std::max(0, cEnd - cLo + 1);
+
+        // 每条射线的值只算一次，再复制到它覆盖的各个分箱
+        for (int c = cLo; c <= cEnd; ++c) {
+            double sum = 0;
+            int valid = 0;
+            bool drawn = false;
+            for (int j = c * k; j < std::min(n, c * k + k); ++j) {
+                const RangeGate &g = ray.gates[j];
+                // 距离范围过滤
+                if (g.distance < view.minDist || g.distance > view.maxDist) continue;
+                drawn = true;
+                if (g.isValid) { sum += turb ? g.turbulence : g.speed; ++valid; }
+            }
+            rowDrawn[c] = drawn;
+            if (!drawn) continue;
+            if (timed) {
+                rowValid[c] = valid > 0;
+                if (valid) rowValues[c] = sum / valid;
+            } else {
+                rowColors[c] = valid ? view.colors.premultiplied(sum / valid) : invalid;
+            }
+        }
+        if (timed) {
+            t1 = clock.nsecsElapsed();
+            for (int c = cLo; c <= cEnd; ++c) {
+                if (rowDrawn[c]) rowColors[c] = rowValid[c] ? view.colors.premultiplied(rowValues[c]) : invalid;
+            }
+            t2 = clock.nsecsElapsed();
+        }
+
+        int lastRow = -1;
+        for (int d = 0; d <= span; ++d) {
+            int b = ((b0 + d) % bins + bins) % bins;
+            if (!m_cull.bins[b] || !PPISpatialIndex::covers(az, (b + 0.5) * PPISpatialIndex::BinWidth)) continue;
+            int row = b / m_binStride;
+            if (row != lastRow) {
+                QRgb *cell = m_grid.data() + 1 + row * m_cols;
+                for (int c = cLo; c <= cEnd; ++c) {
+                    if (rowDrawn[c]) cell[c] = rowColors[c];
+                }
+                m_stats.cellsWritten += std::max(0, cEnd - cLo + 1);
+                lastRow = row;
+            }
+            if (markDirty) {
+                m_dirtyBins[b] = true;
+                m_hasDirty = true;
+            }
+        }
+        if (timed) {
+            tTraverse += t1 - t0;
+            tColor += t2 - t1;
+            tRaster += clock.nsecsElapsed() - t2;
+        }
+    }
+    if (!timed) tTraverse = clock.nsecsElapsed();
+    m_stats.traversalMs += tTraverse / 1e6;
+    m_stats.colorMs += tColor / 1e6;
+    m_stats.rasterMs += tRaster / 1e6;
+}
+
+// 被改写分箱在图像上的外接矩形（环形扇区的包围盒，按连续分箱段求并）
+QRect PPIRenderer::dirtyRect(const PPIView &view) const {
+    if (!m_hasDirty || m_gates == 0) return QRect();
+    const int bins = PPISpatialIndex::Bins;
+    const double rIn = m_edges.first() * view.pxPerM, rOut = m_edges.last() * view.pxPerM;
+    const QPointF o = view.origin;
+    auto at = [&](double r, double deg) {
+        double a = qDegreesToRadians(deg);
+        return o + QPointF(r * std::cos(a), r * std::sin(a));
+    };
+
+    QRectF box;
+    for (int b = 0; b < bins; ) {
+        if (!m_dirtyBins[b]) { ++b; continue; }
+        int e = b;
+        while (e < bins && m_dirtyBins[e]) ++e;
+        // 屏幕角 = 方位 + 15
+        double a0 = b * PPISpatialIndex::BinWidth + 15.0, a1 = e * PPISpatialIndex::BinWidth + 15.0;
+        QPolygonF pts;
+        pts << at(rIn, a0) << at(rOut, a0) << at(rIn, a1) << at(rOut, a1);
+        for (double c = std::ceil(a0 / 90.0) * 90.0; c < a1; c += 90.0) pts << at(rOut, c);
+        box = box.isNull() ? pts.boundingRect() : box.united(pts.boundingRect());
+        b = e;
+    }
+    return box.toAlignedRect().adjusted(-1, -1, 1, 1).intersected(QRect(QPoint(0, 0), view.size));
+}
+
+// ---------------------------------------------------------
+// 共用查找表缓存
+// ---------------------------------------------------------
+bool PPIGeometryCache::find(const Key &key, QVector<quint32> &idx) {
+    QMutexLocker lock(&m_mutex);
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (m_entries[i].first == key) {
+            idx = m_entries[i].second;
+            if (i > 0) m_entries.move(i, 0);
+            return true;
+        }
+    }
+    return false;
+}
+
+void PPIGeometryCache::insert(const Key &key, const QVector<quint32> &idx) {
+    QMutexLocker lock(&m_mutex);
+    for (const auto &e : m_entries)
+        if (e.first == key) return; // 别的视图已经先建好了
+    m_entries.prepend(qMakePair(key, idx));
+    while (m_entries.size() > m_capacity) m_entries.removeLast();
+}
+
+void PPIGeometryCache::clear() {
+    QMutexLocker lock(&m_mutex);
+    m_entries.clear();
+}
+
+void PPIRenderer::setGeometryCache(const QSharedPointer<PPIGeometryCache> &cache) {
+    QMutexLocker lock(&m_mutex);
+    m_geometry = cache;
+}
+
+// ---------------------------------------------------------
+// 像素查找表：每个像素对应的网格下标，0 表示落在数据范围外
+// ---------------------------------------------------------
+PPIRenderer::PixelLut &PPIRenderer::lutFor(const PPIView &view, bool &needsBuild) {
+    for (PixelLut &lut : m_luts) {
+        if (lut.size == view.size && lut.origin == view.origin && lut.pxPerM == view.pxPerM && lut.edges == m_edges
+            && lut.gateStride == m_gateStride && lut.binStride == m_binStride) {
+            needsBuild = false;
+            return lut;
+        }
+    }
+    PixelLut &lut = m_luts[m_lutNext];
+    m_lutNext = (m_lutNext + 1) % 2;
+    lut.size = view.size;
+    lut.origin = view.origin;
+    lut.pxPerM = view.pxPerM;
+    lut.edges = m_edges;
+    lut.gateStride = m_gateStride;
+    lut.binStride = m_binStride;
+    lut.stamp = ++m_lutStamp;
+    // 别的视图建过同样几何的表就直接引用；否则新分配一块（不能与缓存里的共享后再并行写）
+    needsBuild = !(m_geometry && m_geometry->find(geometryKey(lut), lut.idx));
+    if (needsBuild) lut.idx = QVector<quint32>(qsizetype(view.size.width()) * view.size.height());
+    return lut;
+}
+
+PPIGeometryCache::Key PPIRenderer::geometryKey(const PixelLut &lut) {
+    PPIGeometryCache::Key key;
+    key.size = lut.size;
+    key.origin = lut.origin;
+    key.pxPerM = lut.pxPerM;
+    key.edges = lut.edges;
+    key.gateStride = lut.gateStride;
+    key.binStride = lut.binStride;
+    return key;
+}
+
+void PPIRenderer::buildLutTile(PixelLut &lut, const QRect &tile) const {
+    const int w = lut.size.width();
+    if (m_gates == 0) {
+        for (int y = tile.top(); y <= tile.bottom(); ++y)
+            std::fill_n(lut.idx.data() + qsizetype(y) * w + tile.left(), tile.width(), 0u);
+        return;
+    }
+
+    const double rMin = m_edges.first(), rMax = m_edges.last();
+    const double mPerPx = 1.0 / lut.pxPerM;
+    const double binsPerDeg = 1.0 / PPISpatialIndex::BinWidth;
+    const int bins = PPISpatialIndex::Bins;
+
+    for (int y = tile.top(); y <= tile.bottom(); ++y) {
+        quint32 *row = lut.idx.data() + qsizetype(y) * w;
+        double dy = y + 0.5 - lut.origin.y();
+        for (int x = tile.left(); x <= tile.right(); ++x) {
+            double dx = x + 0.5 - lut.origin.x();
+            double r = std::sqrt(dx * dx + dy * dy) * mPerPx;
+            if (r < rMin || r >= rMax) { row[x] = 0; continue; }
+
+            // 逆向公式：az = angle - 15
+            double az = qRadiansToDegrees(std::atan2(dy, dx)) - 15.0;
+            if (az < 0) az += 360.0;
+            int bin = std::min(bins - 1, int(az * binsPerDeg));
+            row[x] = quint32(1 + (bin / m_binStride) * m_cols + gateOf(r) / m_gateStride);
+        }
+    }
+}
+
+// ---------------------------------------------------------
+// 按图块并行：每块先补齐查找表（如需），再从网格取色写入共享图像。
+// keepCanvas：全分辨率帧，查找表未变时只重填脏扇区，结果留作下一帧的画布
+// ---------------------------------------------------------
+QImage PPIRenderer::rasterize(const PPIView &view, bool keepCanvas) {
+    QElapsedTimer clock;
+    clock.start();
+    bool needsBuild = false;
+    PixelLut &lut = lutFor(view, needsBuild);
+    if (keepCanvas) m_stats.lutHit = !needsBuild;
+
+    QRect area(QPoint(0, 0), view.size);
+    QImage img;
+    if (keepCanvas && !needsBuild && m_canvasStamp == lut.stamp) {
+        img = m_canvas;
+        area = dirtyRect(view);
+        m_stats.incremental = true;
+    } else {
+        img = QImage(view.size, QImage::Format_ARGB32_Premultiplied);
+    }
+    if (keepCanvas) {
+        m_dirtyBins.fill(false);
+        m_hasDirty = false;
+    }
+    if (area.isEmpty()) return img;
+
+    uchar *bits = img.bits(); // 先取指针，工作线程里不再触碰 QImage 对象本身
+    const qsizetype bpl = img.bytesPerLine();
+    const QRgb *grid = m_grid.constData();
+    const int w = view.size.width();
+
+    // 查找表要重建时必须按整图切块；增量重填只切脏矩形
+    QVector<QRect> tiles;
+    for (int y = area.top(); y <= area.bottom(); y += TileSize)
+        for (int x = area.left(); x <= area.right(); x += TileSize)
+            tiles << QRect(x, y, TileSize, TileSize).intersected(area);
+
+    QtConcurrent::blockingMap(&m_tilePool, tiles, [&](const QRect &tile) {
+        if (needsBuild) buildLutTile(lut, tile);
+        for (int y = tile.top(); y <= tile.bottom(); ++y) {
+            QRgb *line = reinterpret_cast<QRgb *>(bits + y * bpl);
+            const quint32 *idx = lut.idx.constData() + qsizetype(y) * w;
+            for (int x = tile.left(); x <= tile.right(); ++x) line[x] = grid[idx[x]];
+        }
+    });
+    if (needsBuild && m_geometry) m_geometry->insert(geometryKey(lut), lut.idx);
+    if (keepCanvas) {
+        m_canvas = img;
+        m_canvasStamp = lut.stamp;
+    }
+    m_stats.pixelsFilled += qsizetype(area.width()) * area.height();
+    m_stats.rasterMs += clock.nsecsElapsed() / 1e6;
+    return img;
+}
+
+PPIRenderStats PPIRenderer::lastStats() const {
+    QMutexLocker lock(&m_statsMutex);
+    return m_lastStats;
+}
+
+QImage PPIRenderer::render(const PPIView &view, const PreviewCallback &preview) {
+    QMutexLocker lock(&m_mutex);
+    QElapsedTimer clock;
+    clock.start();
+    m_stats = PPIRenderStats();
+
+    // 细节层次与裁剪窗口都按全分辨率视图决定，预览、草图与正式帧共用同一张网格
+    int gateStride, binStride;
+    chooseLod(view, gateStride, binStride);
+    CullWindow cull = cullFor(view);
+
+    const RadarRay *data = view.rays.constData();
+    bool sameBase = m_gridKey.revision == view.dataRevision && m_gridKey.data == data
+        && m_gridKey.begin == view.begin && m_gridKey.mode == view.mode
+        && m_gridKey.colorSerial == view.colors.serial()
+        && m_gridKey.minDist == view.minDist && m_gridKey.maxDist == view.maxDist
+        && m_gridKey.gateStride == gateStride && m_gridKey.binStride == binStride
+        && m_cull.contains(cull);
+    if (sameBase && view.end > m_gridKey.end && m_gates > 0) {
+        // 播放前进：只补写新露出的射线
+        stampRays(view, m_gridKey.end, view.end, true);
+        m_gridKey.end = view.end;
+        m_stats.gridHit = true;
+    } else if (!sameBase || view.end != m_gridKey.end) {
+        // 回退/跳转/参数变化/缩放档位变化/移出已填范围：整体重建
+        m_gateStride = gateStride;
+        m_binStride = binStride;
+        m_cull = cull;
+        buildGrid(view);
+        m_gridKey = GridKey{view.dataRevision, data, view.begin, view.end, view.mode, view.colors.serial(),
+                            view.minDist, view.maxDist, gateStride, binStride};
+    } else {
+        m_stats.gridHit = true;
+    }
+
+    // 交互中先出一张低分辨率预览，让界面尽快有东西可看
+    if (preview && view.size.width() >= TileSize && view.size.height() >= TileSize) {
+        PPIView coarse = view;
+        coarse.size = view.size / PreviewFactor;
+        coarse.origin = view.origin / PreviewFactor;
+        coarse.pxPerM = view.pxPerM / PreviewFactor;
+        preview(rasterize(coarse, false), coarse);
+    }
+    QImage img = rasterize(view, true);
+
+    m_stats.totalMs = clock.nsecsElapsed() / 1e6;
+    QMutexLocker statsLock(&m_statsMutex);
+    m_lastStats = m_stats;
+    return img;
+}
@@ -0,0 +1,173 @@
+#ifndef PPIRENDERER_H
+#define PPIRENDERER_H
+
+#include "datatypes.h"
+#include "colormap.h"
+#include "renderstats.h"
+#include <QImage>
+#include <QPainter>
+#include <QMutex>
+#include <QThreadPool>
+#include <QSharedPointer>
+#include <functional>
+#include <atomic>
+
+// 渲染一帧 PPI 热力图所需的全部输入。
+// 全部按值保存（ScanData 隐式共享，拷贝代价很小），可以安全地交给工作线程。
+struct PPIView {
+    QSize size;                  // 目标图像大小 (像素)
+    QPointF origin;              // 雷达中心在图像中的位置
+    double pxPerM = 0.0;         // 比例尺：像素/米
+    double lodScale = 1.0;       // 草图按缩小 lodScale 倍的画布出图；细节层次与裁剪仍按全分辨率几何选，和正式帧共用网格
+    DisplayMode mode = Mode_Speed;
+    ColorMap colors;             // 当前模式的色标查找表
+    double minDist = 0.0;        // 距离显示范围
+    double maxDist = 10000.0;
+    ScanData rays;               // 射线来源
+    int begin = 0;               // 只绘制 [begin, end)
+    int end = 0;
+    quint64 dataRevision = 0;    // 射线内容的版本号，变化时重建极坐标网格
+    QVector<bool> rayMask;       // 非空时只画为 true 的射线（混合扫描时排除 RHI）
+};
+
+// 多个渲染器共用的像素查找表缓存：小多图各格尺寸相同、平移缩放联动时几何完全一致，
+// 一个视图建好表，其余直接引用（QVector 隐式共享，不额外占内存）。线程安全。
+class PPIGeometryCache
+{
+public:
+    struct Key {
+        QSize size;
+        QPointF origin;
+        double pxPerM = 0.0;
+        QVector<float> edges;
+        int gateStride = 1, binStride = 1;
+        bool operator==(const Key& o) const {
+            return size == o.size && origin == o.origin && pxPerM == o.pxPerM && gateStride == o.gateStride
+                && binStride == o.binStride && edges == o.edges;
+        }
+    };
+
+    explicit PPIGeometryCache(int capacity = 4) : m_capacity(capacity) {}
+    bool find(const Key& key, QVector<quint32>& idx);
+    void insert(const Key& key, const QVector<quint32>& idx);
+    void clear();
+
+private:
+    QMutex m_mutex;
+    QList<QPair<Key, QVector<quint32>>> m_entries; // 最近用过的在前
+    int m_capacity;
+};
+
+// 与窗口无关的 PPI 光栅化器：
+//  1. 极坐标网格：0.1° 方位分箱 × 距离门，每格存最终颜色（后画的射线覆盖先画的）；
+//     只在数据/模式/距离范围变化时重建
+//  2. 像素查找表：每个像素预先算好落在哪个方位分箱、哪个距离门，合成网格下标；
+//     只在尺寸/比例尺/平移变化时重建
+//  3. 填充：逐行 out[x] = grid[lut[x]]，无分支，代价只与像素数有关
+// 查找表构建与填充按图块切分，在专用线程池上并行写入同一张 QImage。
+// 播放时只有 end 增长：新射线直接写进已有网格，并且只重填这些射线所在扇区的外接矩形，
+// 其余像素沿用上一帧的全分辨率画布。
+// 细节层次：缩小时不足一个像素的距离门/方位分箱按 2 的幂合并成一格（取均值/后画覆盖）；
+// 视口裁剪：网格只填与视图相交的方位和距离范围，放大后网格构建代价只与可见部分有关。
+class PPIRenderer
+{
+public:
+    // 粗略预览回调：在工作线程中调用，参数为预览图及其对应的视图几何
+    typedef std::function<void(const QImage&, const PPIView&)> PreviewCallback;
+
+    static constexpr int TileSize = 256;
+    static constexpr int PreviewFactor = 4; // 预览图分辨率为 1/4
+    static constexpr int MaxGateStride = 64;
+    static constexpr int MaxBinStride = 16; // 3600 能被 16 整除
+
+    // tileThreads < 0：按核数自动；批量导出时每个任务各用一个渲染器，图块串行即可
+    explicit PPIRenderer(int tileThreads = -1);
+
+    // 渲染整帧；给了 preview 时先出一张低分辨率预览，再出全分辨率
+    QImage render(const PPIView& view, const PreviewCallback& preview = PreviewCallback());
+
+    // 与其他渲染器共用像素查找表（可为空）；会等待正在进行的渲染
+    void setGeometryCache(const QSharedPointer<PPIGeometryCache>& cache);
+
+    // 最近一次 render 的统计；可在任意线程调用，不会等待正在进行的渲染
+    PPIRenderStats lastStats() const;
+    // 逐条射线拆分 遍历/取色/写网格 三段耗时（给性能叠加层看）；关闭时只计整段耗时，记在遍历里。
+    // 可在任意线程调用，下一次 render 生效
+    void setDetailedTiming(bool on) { m_detailedTiming = on; }
+
+    // 叠加层：窗口与离线导出共用
+    static void drawRangeRings(QPainter& p, const QPointF& center, double pxPerM, double minDist, double maxDist);
+    static QSize legendSize();
+    static void drawLegend(QPainter& p, const ColorMap& colors, DisplayMode mode); // 局部坐标，左上角为底板
+
+private:
+    // 某个视图几何下的像素查找表
+    struct PixelLut {
+        QSize size;
+        QPointF origin;
+        double pxPerM = 0.0;
+        QVector<float> edges;
+        int gateStride = 1, binStride = 1;
+        QVector<quint32> idx;
+        quint64 stamp = 0;    // 每次重建递增，用来判断画布是否基于这张表
+    };
+
+    // 视图覆盖的极坐标范围
+    struct CullWindow {
+        double rLo = 0.0, rHi = 0.0;   // 距离范围 (米)
+        QVector<bool> bins;            // 可见的方位分箱
+        bool contains(const CullWindow& o) const;
+    };
+    static CullWindow cullFor(const PPIView& view);
+    static void chooseLod(const PPIView& view, int& gateStride, int& binStride);
+
+    void buildGrid(const PPIView& view);
+    void stampRays(const PPIView& view, int from, int to, bool markDirty);
+    QRect dirtyRect(const PPIView& view) const;
+    PixelLut& lutFor(const PPIView& view, bool& needsBuild);
+    static PPIGeometryCache::Key geometryKey(const PixelLut& lut);
+    void buildLutTile(PixelLut& lut, const QRect& tile) const;
+    QImage rasterize(const PPIView& view, bool keepCanvas);
+    int gateOf(double distance) const;
+
+    QMutex m_mutex;
+    QThreadPool m_tilePool;
+
+    PPIRenderStats m_stats;          // 本次渲染累计中
+    PPIRenderStats m_lastStats;
+    mutable QMutex m_statsMutex;
+    std::atomic<bool> m_detailedTiming{false};
+
+    // 极坐标网格
+    QVector<QRgb> m_grid;    // [0] 为透明背景，1 + (分箱/m_binStride) * m_cols + 门号/m_gateStride
+    QVector<float> m_edges;  // 距离门边界 d_0 .. d_n-1
+    int m_gates = 0;         // 可绘制的门数 (n-1)
+    int m_gateStride = 1, m_binStride = 1;
+    int m_cols = 0;          // 合并后的门列数
+    CullWindow m_cull;
+    bool m_uniform = false;
+    double m_d0 = 0.0, m_dr = 0.0;
+    struct GridKey {
+        quint64 revision = ~0ull;
+        const RadarRay* data = nullptr;
+        int begin = -1, end = -1;
+        DisplayMode mode = Mode_Speed;
+        quint64 colorSerial = 0;
+        double minDist = 0.0, maxDist = 0.0;
+        int gateStride = 0, binStride = 0;
+    } m_gridKey;
+
+    // 像素查找表：保留两份，预览与全分辨率交替使用时都能命中
+    PixelLut m_luts[2];
+    int m_lutNext = 0;
+    quint64 m_lutStamp = 0;
+    QSharedPointer<PPIGeometryCache> m_geometry;
+
+    // 增量播放：上一帧全分辨率画布，以及之后新写入网格的方位分箱
+    QImage m_canvas;
+    quint64 m_canvasStamp = 0;   // 画布所用查找表的 stamp，0 表示画布失效
+    QVector<bool> m_dirtyBins;
+    bool m_hasDirty = false;
+};
+
+#endif // PPIRENDERER_H
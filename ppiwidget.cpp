@@ -1,10 +1,15 @@
 #include "ppiwidget.h"
+#include "ppiglview.h"
 #include <QPainter>
 #include <QPainterPath>
 #include <QMouseEvent>
 #include <QWheelEvent>
 #include <QtMath>
 #include <QToolTip>
+#include <QtConcurrent>
+#include <QPointer>
+#include <QElapsedTimer>
+#include <algorithm>
 
 PPIWidget::PPIWidget(QWidget *parent) : QWidget(parent) {
     // 【关键1】必须开启鼠标追踪，否则不按键时无法触发悬停事件
@@ -13,63 +18,423 @@ PPIWidget::PPIWidget(QWidget *parent) : QWidget(parent) {
     m_offset = QPointF(0, 0);
     // 确保能正常显示背景色
     setAttribute(Qt::WA_StyledBackground, true);
+
+    // 离屏渲染：后台线程完成后换上新缓存
+    m_renderWatcher = new QFutureWatcher<QImage>(this);
+    connect(m_renderWatcher, &QFutureWatcher<QImage>::finished, this, &PPIWidget::onRenderFinished);
+
+    // 平移/缩放停下来一小段时间后再按新视图重新光栅化
+    m_settleTimer = new QTimer(this);
+    m_settleTimer->setSingleShot(true);
+    m_settleTimer->setInterval(120);
+    connect(m_settleTimer, &QTimer::timeout, this, &PPIWidget::requestRender);
+
+    m_refineTimer = new QTimer(this);
+    m_refineTimer->setSingleShot(true);
+    m_refineTimer->setInterval(300);
+    connect(m_refineTimer, &QTimer::timeout, this, &PPIWidget::onInteractionFinished);
+}
+
+PPIWidget::~PPIWidget() {
+    // 后台渲染引用了 m_renderer，必须等它结束
+    m_renderWatcher->waitForFinished();
+}
+
+void PPIWidget::setRenderBackend(RenderBackend backend) {
+    if (backend == renderBackend()) return;
+    if (backend == Backend_OpenGL) {
+        m_glView = new PPIGLView(this);
+        m_glView->setGeometry(rect());
+        // 排队处理：失败发生在 initializeGL 里，不能当场删掉它
+        connect(m_glView, &PPIGLView::glFailed, this, &PPIWidget::fallbackToSoftware, Qt::QueuedConnection);
+        m_glView->show();
+        viewChanged();
+        // 有的平台拿不到上下文也不报错，只是一直不初始化
+        QPointer<PPIGLView> gl = m_glView;
+        QTimer::singleShot(1000, this, [this, gl]() {
+            if (gl && gl == m_glView && gl->isVisible() && !gl->isReady() && !gl->hasFailed())
+                fallbackToSoftware("OpenGL 上下文初始化超时");
+        });
+    } else {
+        m_glView->deleteLater();
+        m_glView = nullptr;
+        m_cacheDirty = true;
+        update();
+    }
+}
+
+void PPIWidget::setStatsOverlayVisible(bool on) {
+    m_showStats = on;
+    m_renderer.setDetailedTiming(on);
+    if (m_glView) m_glView->update();
+    else update();
+}
+
+void PPIWidget::resetFrameStats() {
+    m_frameStats = PPIFrameStats();
+    m_frameTimes.clear();
+}
+
+bool PPIWidget::exportFrameTimesCsv(const QString &path) const {
+    return m_frameTimes.exportCsv(path, m_glView ? "OpenGL" : "Software");
+}
+
+void PPIWidget::recordFrame(double paintMs, bool cacheHit) {
+    m_frameStats.paintMs = paintMs;
+    m_frameStats.cacheHit = cacheHit;
+    if (cacheHit) m_frameStats.cacheHits++;
+    else m_frameStats.cacheMisses++;
+    m_frameTimes.add(paintMs);
+}
+
+void PPIWidget::fallbackToSoftware(const QString &reason) {
+    if (!m_glView) return;
+    setRenderBackend(Backend_Software);
+    emit renderBackendFallback(reason);
+}
+
+void PPIWidget::viewChanged() {
+    if (!m_glView) {
+        update();
+        return;
+    }
+    if (!m_data || m_data->isEmpty()) {
+        m_glView->setView(PPIView());
+        return;
+    }
+    PPIView v = makeView(false);
+    if (!PPIGLView::supportsGeometry(v)) {
+        fallbackToSoftware("距离门不等间距，OpenGL 渲染不支持");
+        return;
+    }
+    m_glView->setView(v);
 }
 
 void PPIWidget::setData(const ScanData *data) {
     m_data = data;
     m_playLimit = -1;
-    update();
+    m_cache = QImage(); // 新数据：同步画第一帧
+    refresh();
 }
 
+// 模式、距离范围不算数据变化：软件网格按 GridKey 里的模式/范围自行重建，
+// OpenGL 只换 uniform 和色标纹理，不重传数据纹理
 void PPIWidget::setDisplayMode(DisplayMode mode) {
     m_mode = mode;
-    update();
+    m_colors = colorMap(mode);
+    m_cacheDirty = true;
+    viewChanged();
 }
 
+ColorMap PPIWidget::colorMap(DisplayMode mode) const {
+    const ColorScale &s = m_scales[mode == Mode_Turbulence ? 1 : 0];
+    if (mode == m_mode && m_colors.palette() == s.palette && m_colors.lo() == s.lo && m_colors.hi() == s.hi)
+        return m_colors;
+    double lo, hi;
+    ColorMap::defaultRange(mode, lo, hi);
+    if (s.palette == ColorMap::Palette_Classic && s.lo == lo && s.hi == hi) return ColorMap(mode); // 默认色标共用
+    return ColorMap(s.palette, s.lo, s.hi, mode);
+}
+
+void PPIWidget::setColorMap(DisplayMode mode, const ColorMap &colors) {
+    m_scales[mode == Mode_Turbulence ? 1 : 0] = ColorScale{colors.palette(), colors.lo(), colors.hi()};
+    if (mode != m_mode) return;
+    m_colors = colors;
+    m_cacheDirty = true;
+    viewChanged();
+}
+
+void PPIWidget::setColorScale(DisplayMode mode, ColorMap::Palette palette, double lo, double hi) {
+    m_scales[mode == Mode_Turbulence ? 1 : 0] = ColorScale{palette, lo, hi};
+    if (mode != m_mode) return;
+    m_colors = colorMap(mode);
+    // 只换色标：网格按色标序号自动重建，不必递增数据版本
+    m_cacheDirty = true;
+    viewChanged();
+}
+
+// 播放进度不算数据变化：不递增版本号，光栅化器据此只补画新射线
 void PPIWidget::setPlayLimit(int limit) {
     m_playLimit = limit;
-    update();
+    m_cacheDirty = true;
+    viewChanged();
 }
 
 void PPIWidget::setDistanceRange(double min, double max) {
     m_minVisDist = min;
     m_maxVisDist = max;
-    update();
+    m_cacheDirty = true;
+    viewChanged();
+}
+
+// 射线内容变了（滤波/野值/湍流窗口/新数据）：递增版本号，网格与数据纹理整体重建
+void PPIWidget::refresh() {
+    m_dataRevision++;
+    m_cacheDirty = true;
+    viewChanged();
+}
+
+void PPIWidget::setPyramid(const TimePyramid *pyramid) {
+    m_pyramid = pyramid;
+    m_ovLevel = -1;
+    refresh();
+}
+
+// 只有当前范围超过射线预算、要画概览时才需要重画；画原始射线时不受影响
+void PPIWidget::pyramidUpdated() {
+    m_ovLevel = -1;
+    if (!m_data || m_data->isEmpty()) return;
+    int begin = 0, end = 0;
+    visibleRayRange(begin, end);
+    if (end - begin > m_maxRaysPerFrame) refresh();
+}
+
+void PPIWidget::setSpatialIndex(const PPISpatialIndex *index) {
+    m_index = index;
 }
 
-// 核心坐标转换：极坐标(雷达) -> 屏幕坐标(像素)
-QPointF PPIWidget::polarToScreen(double azimuth, double distance, QPointF center) {
-    // 角度：雷达0度 = 屏幕东偏南15度 (Qt 0度是东)
-    double angleRad = qDegreesToRadians(azimuth + 15.0);
+void PPIWidget::setTimeWindow(const QDateTime &from, const QDateTime &to) {
+    m_winFrom = from;
+    m_winTo = to;
+    refresh();
+}
+
+void PPIWidget::setRayRange(int begin, int end) {
+    m_rangeBegin = begin;
+    m_rangeEnd = end;
+    refresh();
+}
+
+void PPIWidget::setRayMask(const QVector<bool> *mask) {
+    m_rayMask = mask;
+    refresh();
+}
+
+void PPIWidget::setViewTransform(double scale, const QPointF &offset, bool interactive) {
+    if (scale == m_scale && offset == m_offset) return;
+    m_scale = scale;
+    m_offset = offset;
+    if (interactive) beginInteraction();
+    viewChanged();
+}
+
+// 确定本帧要画的射线：时间窗口 + 播放进度决定原始射线范围，
+// 范围过大时从金字塔中选一层合并出概览（结果缓存，窗口不变不重算）
+void PPIWidget::visibleRayRange(int &begin, int &end) const {
+    auto byTime = [](const RadarRay &r, const QDateTime &t) { return r.timestamp < t; };
+    begin = m_winFrom.isValid() ? int(std::lower_bound(m_data->begin(), m_data->end(), m_winFrom, byTime) - m_data->begin()) : 0;
+    end = m_winTo.isValid() ? int(std::lower_bound(m_data->begin(), m_data->end(), m_winTo, byTime) - m_data->begin()) : m_data->size();
+    if (m_rangeBegin >= 0) begin = qMax(begin, qMin(m_rangeBegin, int(m_data->size())));
+    if (m_rangeEnd >= 0) end = qMin(end, m_rangeEnd);
+    if (m_playLimit != -1) end = qMin(end, m_playLimit);
+    end = qMax(begin, end);
+}
+
+const ScanData& PPIWidget::raysToDraw(int &begin, int &end) {
+    visibleRayRange(begin, end);
+
+    m_level = 0;
+    // 金字塔还在后台建时先画原始射线
+    if (!m_pyramid || m_pyramid->isEmpty() || end - begin <= m_maxRaysPerFrame) return *m_data;
+
+    qint64 t0 = m_data->at(begin).timestamp.toMSecsSinceEpoch();
+    qint64 t1 = m_data->at(end - 1).timestamp.toMSecsSinceEpoch() + 1;
+    m_level = m_pyramid->chooseLevel(t0, t1, m_maxMergeBuckets);
+    if (m_level != m_ovLevel || t0 != m_ovT0 || t1 != m_ovT1 || m_pyramid->revision() != m_ovRevision) {
+        m_overview = m_pyramid->overview(m_level, t0, t1);
+        m_ovLevel = m_level; m_ovT0 = t0; m_ovT1 = t1;
+        m_ovRevision = m_pyramid->revision();
+    }
+    begin = 0;
+    end = m_overview.size();
+    return m_overview;
+}
 
-    // 比例尺：4000米映射到窗口半径的 1/2.2
+// 比例尺：4000米映射到窗口半径的 1/2.2
+double PPIWidget::pixelsPerMeter() const {
     double baseRadius = qMin(width(), height()) / 2.2;
-    double pxPerM = (baseRadius / 4000.0) * m_scale;
+    return (baseRadius / 4000.0) * m_scale;
+}
 
-    double r = distance * pxPerM;
-    double x = center.x() + m_offset.x() + r * qCos(angleRad);
-    double y = center.y() + m_offset.y() + r * qSin(angleRad);
-    return QPointF(x, y);
+// 当前视图对应的渲染参数：缓存图比窗口四周各大出 CacheMargin，平移时不必马上重绘
+// （OpenGL 每帧都在 GPU 上重画，不需要留边）
+PPIView PPIWidget::makeView(bool withMargin) {
+    double k = withMargin ? CacheMargin : 0.0;
+    QPointF margin(width() * k, height() * k);
+    PPIView v;
+    v.size = QSize(qRound(width() + 2 * margin.x()), qRound(height() + 2 * margin.y()));
+    v.origin = QPointF(rect().center()) + m_offset + margin;
+    v.pxPerM = pixelsPerMeter();
+    v.mode = m_mode;
+    v.colors = m_colors;
+    v.minDist = m_minVisDist;
+    v.maxDist = m_maxVisDist;
+    int begin = 0, end = 0;
+    v.rays = raysToDraw(begin, end);
+    v.begin = begin;
+    v.end = end;
+    v.dataRevision = m_dataRevision;
+    // 概览射线是重新合成的，下标与原始数据对不上，不套掩码
+    // 概览射线来自金字塔，建金字塔时已经排除了 RHI，不用再掩
+    if (m_rayMask && m_level == 0 && m_rayMask->size() == m_data->size()) v.rayMask = *m_rayMask;
+    return v;
 }
 
-QColor PPIWidget::valueToColor(double val) {
-    if (m_mode == Mode_Turbulence) {
-        double norm = qBound(0.0, val / 0.5, 1.0);
-        return QColor::fromHsv(120 * (1.0 - norm), 255, 255, 220);
-    } else {
-        double norm = (val + 10.0) / 20.0;
-        norm = qBound(0.0, norm, 1.0);
-        return QColor::fromHsv(240 * (1.0 - norm), 255, 255, 220);
+// 交给后台线程重新光栅化；上一张还没画完时只记一笔，画完后再补一次
+void PPIWidget::requestRender() {
+    m_settleTimer->stop();
+    if (!m_data || m_data->isEmpty() || width() <= 0 || height() <= 0) return;
+    if (m_renderWatcher->isRunning()) {
+        m_renderPending = true;
+        return;
+    }
+    // 交互中只出草图；只是平移/缩放（数据没变）时先出粗略预览，逐步细化
+    bool draft = m_interacting;
+    bool progressive = !m_cacheDirty && !draft;
+    m_renderPending = false;
+    m_cacheDirty = false;
+    PPIView v = makeView();
+    if (draft) {
+        // 尺寸向上取整，换算回全分辨率时裁剪窗口不会比正式帧小
+        v.size = QSize((v.size.width() + DraftFactor - 1) / DraftFactor, (v.size.height() + DraftFactor - 1) / DraftFactor);
+        v.origin /= DraftFactor;
+        v.pxPerM /= DraftFactor;
+        v.lodScale = DraftFactor;
+    }
+    m_jobDraft = draft;
+    m_jobOrigin = v.origin;
+    m_jobPxPerM = v.pxPerM;
+    m_jobRevision = v.dataRevision;
+    m_jobColorSerial = v.colors.serial();
+    m_jobMode = v.mode;
+
+    PPIRenderer::PreviewCallback preview;
+    if (progressive) {
+        preview = [this](const QImage &img, const PPIView &coarse) {
+            QPointF origin = coarse.origin;
+            double pxPerM = coarse.pxPerM;
+            quint64 revision = coarse.dataRevision, serial = coarse.colors.serial();
+            DisplayMode mode = coarse.mode;
+            QMetaObject::invokeMethod(this, [this, img, origin, pxPerM, revision, serial, mode]() {
+                if (!m_renderWatcher->isRunning()) return; // 全分辨率已经到了
+                if (!isCurrentJob(revision, serial, mode)) return; // 数据已经换了
+                m_cache = img;
+                m_cacheOrigin = origin;
+                m_cachePxPerM = pxPerM;
+                m_cacheDraft = false;
+                update();
+            }, Qt::QueuedConnection);
+        };
+    }
+    m_renderWatcher->setFuture(QtConcurrent::run([this, v, preview]() { return m_renderer.render(v, preview); }));
+}
+
+// 渲染期间数据/色标/模式变了，这一帧就是旧内容：丢掉，靠 m_renderPending 或 m_cacheDirty 补画
+void PPIWidget::onRenderFinished() {
+    if (isCurrentJob(m_jobRevision, m_jobColorSerial, m_jobMode)) {
+        m_cache = m_renderWatcher->result();
+        m_cacheOrigin = m_jobOrigin;
+        m_cachePxPerM = m_jobPxPerM;
+        m_cacheDraft = m_jobDraft;
+    } else if (!m_renderPending) {
+        m_cacheDirty = true;
+    }
+    m_frameStats.render = m_renderer.lastStats();
+    if (m_renderPending) requestRender();
+    update();
+}
+
+// 鼠标/滚轮输入：进入草图模式，停手一段时间后 onInteractionFinished 恢复全画质
+void PPIWidget::beginInteraction() {
+    m_interacting = true;
+    m_refineTimer->start();
+}
+
+void PPIWidget::onInteractionFinished() {
+    if (m_isDragging) { // 按住不动也算交互中
+        m_refineTimer->start();
+        return;
+    }
+    m_interacting = false;
+    if (m_cacheDraft && !m_glView) requestRender();
+    update(); // 叠加层恢复抗锯齿
+}
+
+void PPIWidget::resizeEvent(QResizeEvent *) {
+    if (m_glView) {
+        m_glView->setGeometry(rect());
+        viewChanged();
+        return;
     }
+    // 先拉伸/平移旧图，停稳后按新尺寸重绘
+    m_settleTimer->start();
 }
 
 void PPIWidget::paintEvent(QPaintEvent *) {
+    if (m_glView) return; // 整个窗口由 OpenGL 子控件负责
+
+    QElapsedTimer frameClock;
+    frameClock.start();
     QPainter p(this);
-    p.setRenderHint(QPainter::Antialiasing);
+    // 交互中不开抗锯齿与平滑缩放，停手后再补
+    p.setRenderHint(QPainter::Antialiasing, !m_interacting);
+    p.setRenderHint(QPainter::SmoothPixmapTransform, !m_interacting);
 
     // 1. 背景设为白色
     p.fillRect(rect(), Qt::white);
 
+    if (!m_data || m_data->isEmpty()) {
+        drawOverlays(p);
+        return;
+    }
+
+    QPointF center = rect().center();
+    double pxPerM = pixelsPerMeter();
+
+    // 2. 热力图：贴离屏缓存。第一帧同步渲染，之后数据/模式/色标变化交给后台线程；
+    //    后台还在画时不同步渲染（会卡在渲染器的锁上）：画的是旧数据就排队，等它完成后再补一帧
+    bool cacheHit = true;
+    if (m_cache.isNull() && m_renderWatcher->isRunning()) {
+        if (!isCurrentJob(m_jobRevision, m_jobColorSerial, m_jobMode)) m_renderPending = true;
+        cacheHit = false;
+    } else if (m_cache.isNull()) {
+        PPIView v = makeView();
+        m_cache = m_renderer.render(v);
+        m_frameStats.render = m_renderer.lastStats();
+        m_cacheOrigin = v.origin;
+        m_cachePxPerM = v.pxPerM;
+        m_cacheDraft = false;
+        m_cacheDirty = false;
+        cacheHit = false;
+    } else if (m_cacheDirty) {
+        requestRender();
+        cacheHit = false;
+    }
+
+    // 比例不变时纯平移贴图；缩放过程中先拉伸旧图，停下后再重绘
+    // （草图本身就是按 1/DraftFactor 渲染的，放大 DraftFactor 倍贴上算比例不变）
+    double s = pxPerM / m_cachePxPerM;
+    double expected = m_cacheDraft ? DraftFactor : 1.0;
+    QPointF topLeft = center + m_offset - m_cacheOrigin * s;
+    // 后台正在渲染时不再排队，等它完成后由下一次绘制决定
+    bool busy = m_renderWatcher->isRunning();
+    if (qFuzzyCompare(s, 1.0)) {
+        p.drawImage(topLeft, m_cache);
+    } else {
+        p.drawImage(QRectF(topLeft, QSizeF(m_cache.size()) * s), m_cache);
+    }
+    if (qFuzzyCompare(s, expected)) {
+        if (!busy && !QRectF(topLeft, QSizeF(m_cache.size()) * s).contains(QRectF(rect()))) m_settleTimer->start();
+    } else if (!busy) {
+        m_settleTimer->start();
+    }
+
+    drawOverlays(p);
+    recordFrame(frameClock.nsecsElapsed() / 1e6, cacheHit);
+}
+
+void PPIWidget::drawOverlays(QPainter &p) {
+    p.setRenderHint(QPainter::Antialiasing, !m_interacting);
     if (!m_data || m_data->isEmpty()) {
         p.setPen(Qt::gray);
         p.drawText(rect(), Qt::AlignCenter, "请点击[导入]并选择文件");
@@ -77,81 +442,92 @@ void PPIWidget::paintEvent(QPaintEvent *) {
     }
 
     QPointF center = rect().center();
-    int limit = (m_playLimit == -1) ? m_data->size() : qMin(m_playLimit, m_data->size());
-
-    // 2. 绘制热力图 (使用清晰的 Polygon 方式)
-    for (int i = 0; i < limit; ++i) {
-        const RadarRay& ray = m_data->at(i);
-        double az1 = ray.azimuth;
-        double az2 = az1 + 1.2; // 略微加宽以消除缝隙
-
-        for (int j = 0; j < ray.gates.size() - 1; ++j) {
-            const RangeGate& g = ray.gates[j];
-
-            // 距离范围过滤
-            if (g.distance < m_minVisDist || g.distance > m_maxVisDist) continue;
-
-            if (!g.isValid) {
-                // 无效数据画浅灰
-                p.setBrush(QColor(240, 240, 240));
-            } else {
-                p.setBrush(valueToColor((m_mode == Mode_Turbulence) ? g.turbulence : g.speed));
-            }
-
-            // 计算四个顶点
-            QPointF p1 = polarToScreen(az1, g.distance, center);
-            QPointF p2 = polarToScreen(az1, ray.gates[j+1].distance, center);
-            QPointF p3 = polarToScreen(az2, ray.gates[j+1].distance, center);
-            QPointF p4 = polarToScreen(az2, g.distance, center);
-
-            QPolygonF poly;
-            poly << p1 << p2 << p3 << p4;
-
-            p.setPen(Qt::NoPen);
-            p.drawPolygon(poly);
-        }
+    double pxPerM = pixelsPerMeter();
+    const bool aa = !m_interacting;
+
+    // 3. 距离刻度圈：以雷达为中心画进一张刚好装下最外圈（含标注）的位图，
+    //    只随比例尺/距离范围变化；平移时把同一张位图贴到新的中心，悬停和播放都不重画。
+    //    放得很大时位图会超过上限，这时直接画（只有几个圆）
+    const double outer = std::min(4000.0, m_maxVisDist) * pxPerM;
+    const int half = int(std::ceil(outer)) + 60; // 右侧留出 "4000m" 标注
+    const QPointF ringCenter = center + m_offset;
+    if (2 * half > MaxRingLayer) {
+        PPIRenderer::drawRangeRings(p, ringCenter, pxPerM, m_minVisDist, m_maxVisDist);
+    } else if (outer > 0) {
+        QString ringKey = QString("%1|%2-%3|%4").arg(pxPerM, 0, 'g', 12).arg(m_minVisDist).arg(m_maxVisDist).arg(aa);
+        p.drawPixmap(ringCenter - QPointF(half, half), cachedLayer(m_ringLayer, ringKey, QSize(2 * half, 2 * half), [&](QPainter &lp) {
+            PPIRenderer::drawRangeRings(lp, QPointF(half, half), pxPerM, m_minVisDist, m_maxVisDist);
+        }));
     }
 
-    // 3. 绘制距离刻度圈
-    p.setPen(QPen(Qt::lightGray, 1, Qt::DashLine));
-    p.setBrush(Qt::NoBrush);
-
-    // 统一比例尺计算
-    double baseRadius = qMin(width(), height()) / 2.2;
-    double pxPerM = (baseRadius / 4000.0) * m_scale;
-
-    for (int r = 1000; r <= 4000; r += 1000) {
-        // 只画在范围内的圈
-        if (r >= m_minVisDist && r <= m_maxVisDist) {
-            double radius = r * pxPerM;
-            // 圈的位置要加上偏移量
-            p.drawEllipse(center + m_offset, radius, radius);
-            p.drawText(center + m_offset + QPointF(radius + 5, 0), QString::number(r) + "m");
-        }
+    // 4. 图例：只随色标/模式变化
+    QString legendKey = QString("%1|%2|%3").arg(m_colors.serial()).arg(m_mode).arg(aa);
+    QSize ls = PPIRenderer::legendSize();
+    const QPixmap &legend = cachedLayer(m_legendLayer, legendKey, ls,
+                                        [this](QPainter &lp) { PPIRenderer::drawLegend(lp, m_colors, m_mode); });
+    p.drawPixmap(width() - ls.width() + 10, height() - ls.height() - 30, legend);
+
+    if (m_level > 0) {
+        QString text = QString("概览: %1 分钟/桶").arg(m_pyramid->bucketSeconds(m_level) / 60);
+        p.drawPixmap(0, 0, cachedLayer(m_labelLayer, text + QString::number(aa), QSize(300, 30), [&](QPainter &lp) {
+            lp.setPen(Qt::darkGray);
+            lp.drawText(10, 20, text);
+        }));
     }
 
-    // 4. 绘制图例
-    drawLegend(p);
+    if (m_showStats) drawStatsHud(p);
 }
 
-void PPIWidget::drawLegend(QPainter &p) {
-    int w = 15, h = 160, m = 40;
-    QRect r(width() - w - m, height() - h - m, w, h);
+// 性能叠加层：每帧都变，不进缓存
+void PPIWidget::drawStatsHud(QPainter &p) {
+    const PPIFrameStats &s = m_frameStats;
+    const PPIRenderStats &r = s.render;
+    QStringList lines;
+    lines << QString("后端: %1").arg(m_glView ? "OpenGL" : "软件")
+          << QString("绘制: %1 ms  (均值 %2 / p95 %3)").arg(s.paintMs, 0, 'f', 2)
+                 .arg(m_frameTimes.mean(), 0, 'f', 2).arg(m_frameTimes.percentile(0.95), 0, 'f', 2)
+          << QString("缓存: 命中 %1 / 未命中 %2   叠加层: %3 / %4")
+                 .arg(s.cacheHits).arg(s.cacheMisses).arg(s.overlayHits).arg(s.overlayMisses);
+    if (!m_glView) {
+        lines << QString("光栅化: %1 ms = 遍历 %2 + 取色 %3 + 填充 %4").arg(r.totalMs, 0, 'f', 1)
+                     .arg(r.traversalMs, 0, 'f', 1).arg(r.colorMs, 0, 'f', 1).arg(r.rasterMs, 0, 'f', 1)
+              << QString("射线: 写入 %1 / 裁剪 %2   网格单元: %3").arg(r.raysStamped).arg(r.raysCulled).arg(r.cellsWritten)
+              << QString("距离门: 裁剪 %1 / 合并 %2   像素: %3").arg(r.gatesCulled).arg(r.gatesMerged).arg(r.pixelsFilled)
+              << QString("网格%1  查找表%2%3").arg(r.gridHit ? "复用" : "重建").arg(r.lutHit ? "复用" : "重建")
+                     .arg(r.incremental ? "  增量" : "");
+    }
+
+    QFontMetrics fm(p.font());
+    int lh = fm.height();
+    QRect box(8, 28, 0, lines.size() * lh + 8);
+    for (const QString &l : lines) box.setWidth(std::max(box.width(), fm.horizontalAdvance(l) + 12));
 
+    p.save();
     p.setPen(Qt::NoPen);
-    p.setBrush(QColor(255, 255, 255, 220));
-    p.drawRect(r.adjusted(-10, -30, 50, 10));
+    p.setBrush(QColor(0, 0, 0, 160));
+    p.drawRect(box);
+    p.setPen(Qt::white);
+    for (int i = 0; i < lines.size(); ++i) p.drawText(box.left() + 6, box.top() + 4 + fm.ascent() + i * lh, lines[i]);
+    p.restore();
+}
 
-    for (int i = 0; i < h; ++i) {
-        double v = (m_mode == Mode_Turbulence) ? (double)(h-i)/h*0.5 : (double)(h-i)/h*20-10;
-        p.setPen(valueToColor(v));
-        p.drawLine(r.left(), r.top() + i, r.right(), r.top() + i);
+// 静态叠加层缓存：key 不变直接复用，变了才重画（透明底，按设备像素比分配）
+const QPixmap &PPIWidget::cachedLayer(OverlayLayer &layer, const QString &key, const QSize &size,
+                                      const std::function<void(QPainter &)> &paint) {
+    const qreal dpr = devicePixelRatioF();
+    if (layer.key == key && !layer.pixmap.isNull() && layer.pixmap.devicePixelRatio() == dpr) {
+        m_frameStats.overlayHits++;
+    } else {
+        m_frameStats.overlayMisses++;
+        layer.pixmap = QPixmap(size * dpr);
+        layer.pixmap.setDevicePixelRatio(dpr);
+        layer.pixmap.fill(Qt::transparent);
+        QPainter lp(&layer.pixmap);
+        lp.setRenderHint(QPainter::Antialiasing, !m_interacting);
+        paint(lp);
+        layer.key = key;
     }
-    p.setPen(Qt::black);
-    p.drawRect(r);
-    p.drawText(r.right() + 5, r.top() + 10, (m_mode == Mode_Turbulence ? "0.5" : "+10"));
-    p.drawText(r.right() + 5, r.bottom(), (m_mode == Mode_Turbulence ? "0.0" : "-10"));
-    p.drawText(r.left() - 5, r.top() - 10, (m_mode == Mode_Turbulence ? "湍流" : "风速"));
+    return layer.pixmap;
 }
 
 // --- 交互事件实现 ---
@@ -162,14 +538,16 @@ void PPIWidget::mousePressEvent(QMouseEvent *e) {
         m_lastMousePos = e->pos();
         setCursor(Qt::ClosedHandCursor);
     }
-    // 发送信号给折线图
-    if (m_data && !m_data->isEmpty()) emit raySelected(m_data->size()/2);
+    // 发送信号给折线图：点中的那条射线
+    int rayIdx = rayAtPosition(e->position());
+    if (rayIdx >= 0) emit raySelected(rayIdx);
 }
 
 void PPIWidget::mouseReleaseEvent(QMouseEvent *e) {
     if (e->button() == Qt::LeftButton) {
         m_isDragging = false;
         unsetCursor();
+        if (m_interacting) m_refineTimer->start(); // 从松手开始计时
     }
 }
 
@@ -177,7 +555,8 @@ void PPIWidget::mouseDoubleClickEvent(QMouseEvent *) {
     // 双击复位功能
     m_scale = 0.8;
     m_offset = {0, 0};
-    update();
+    viewChanged();
+    emit viewTransformChanged(m_scale, m_offset);
 }
 
 void PPIWidget::wheelEvent(QWheelEvent *e) {
@@ -192,7 +571,9 @@ void PPIWidget::wheelEvent(QWheelEvent *e) {
 
     // 中心缩放补偿
     m_offset = pRel - (pRel - m_offset) * actualF;
-    update();
+    beginInteraction();
+    viewChanged();
+    emit viewTransformChanged(m_scale, m_offset);
 }
 
 // 【核心修复】鼠标移动事件：反算坐标显示 ToolTip
@@ -202,72 +583,80 @@ void PPIWidget::mouseMoveEvent(QMouseEvent *e) {
         QPoint delta = e->pos() - m_lastMousePos;
         m_offset += QPointF(delta.x(), delta.y());
         m_lastMousePos = e->pos();
-        update();
+        beginInteraction();
+        viewChanged();
+        emit viewTransformChanged(m_scale, m_offset);
         return;
     }
 
-    // 2. 处理悬停提示
-    if (!m_data || m_data->isEmpty()) return;
+    // 2. 处理悬停提示：空间索引直接定位射线与距离门
+    int gate = -1;
+    int rayIdx = rayAtPosition(e->position(), &gate);
+    if (rayIdx != m_hoverRay) {
+        m_hoverRay = rayIdx;
+        emit rayHovered(rayIdx);
+    }
 
-    QPointF center = rect().center();
+    QString info;
+    if (rayIdx >= 0 && gate >= 0) {
+        const RadarRay& ray = m_data->at(rayIdx);
+        const RangeGate& g = ray.gates[gate];
+        info = QString("方位: %1°\n距离: %2 m\n风速: %3 m/s\nSNR: %4\n湍流: %5")
+                   .arg(ray.azimuth, 0, 'f', 1)
+                   .arg(g.distance, 0, 'f', 0)
+                   .arg(g.speed, 0, 'f', 2)
+                   .arg(g.snr, 0, 'f', 1)
+                   .arg(g.turbulence, 0, 'f', 3);
+    }
 
-    // 关键步骤A：反算鼠标相对于圆心的偏移量（必须减去平移量 m_offset）
-    double dx = e->position().x() - center.x() - m_offset.x();
-    double dy = e->position().y() - center.y() - m_offset.y();
+    if (!info.isEmpty()) {
+        QToolTip::showText(e->globalPosition().toPoint(), info, this);
+    } else {
+        QToolTip::hideText(); // 移出有效区隐藏
+    }
+}
 
-    // 关键步骤B：计算比例尺（必须与 paintEvent 中的公式一模一样）
-    double baseRadius = qMin(width(), height()) / 2.2;
-    double pxPerM = (baseRadius / 4000.0) * m_scale;
+void PPIWidget::leaveEvent(QEvent *) {
+    if (m_hoverRay >= 0) {
+        m_hoverRay = -1;
+        emit rayHovered(-1);
+    }
+}
 
-    // 反算出实际距离
-    double dist_m = std::sqrt(dx*dx + dy*dy) / pxPerM;
+// 屏幕坐标 -> 雷达极坐标 (与 polarToScreen 互逆)
+void PPIWidget::screenToPolar(const QPointF &pos, double &azimuth, double &distance) const {
+    QPointF center = rect().center();
+    // 反算鼠标相对于圆心的偏移量（必须减去平移量 m_offset）
+    double dx = pos.x() - center.x() - m_offset.x();
+    double dy = pos.y() - center.y() - m_offset.y();
 
-    // 关键步骤C：反算出方位角
-    // 绘图公式：angle = az + 15
-    // 逆向公式：az = angle - 15
-    double angleRad = std::atan2(dy, dx);
-    double angleDeg = qRadiansToDegrees(angleRad);
-    double az = angleDeg - 15.0;
+    distance = std::sqrt(dx*dx + dy*dy) / pixelsPerMeter();
 
-    // 归一化到 0~360
+    // 绘图公式：angle = az + 15，逆向：az = angle - 15，归一化到 0~360
+    double az = qRadiansToDegrees(std::atan2(dy, dx)) - 15.0;
     while (az < 0) az += 360;
     while (az >= 360) az -= 360;
+    azimuth = az;
+}
 
-    // 3. 在数据中查找
-    QString info;
-    const RadarRay* bestRay = nullptr;
-    double minAzDiff = 100.0;
-
-    // 找最近的射线
-    for (const auto& ray : *m_data) {
-        double diff = std::abs(ray.azimuth - az);
-        if (diff > 180) diff = 360 - diff;
-        if (diff < minAzDiff) {
-            minAzDiff = diff;
-            bestRay = &ray;
-        }
-    }
+// 鼠标位置下实际绘制的那条射线（考虑时间窗口与播放进度），gate 返回距离门号
+int PPIWidget::rayAtPosition(const QPointF &pos, int *gate) const {
+    if (gate) *gate = -1;
+    if (!m_data || m_data->isEmpty() || !m_index) return -1;
 
-    // 阈值判定：鼠标必须指在有效数据范围内 (角度偏差<2度，距离<4000)
-    if (bestRay && minAzDiff < 2.0 && dist_m <= 4000) {
-        // 找最近的距离门
-        for (const auto& gate : bestRay->gates) {
-            // 距离容差设为 30米
-            if (std::abs(gate.distance - dist_m) < 30.0) {
-                info = QString("方位: %1°\n距离: %2 m\n风速: %3 m/s\nSNR: %4\n湍流: %5")
-                           .arg(bestRay->azimuth, 0, 'f', 1)
-                           .arg(gate.distance, 0, 'f', 0)
-                           .arg(gate.speed, 0, 'f', 2)
-                           .arg(gate.snr, 0, 'f', 1)
-                           .arg(gate.turbulence, 0, 'f', 3);
-                break;
-            }
-        }
-    }
+    double az, dist;
+    screenToPolar(pos, az, dist);
 
-    if (!info.isEmpty()) {
-        QToolTip::showText(e->globalPosition().toPoint(), info, this);
-    } else {
-        QToolTip::hideText(); // 移出有效区隐藏
+    int begin, end;
+    visibleRayRange(begin, end);
+    int rayIdx = m_index->rayAt(*m_data, az, begin, end);
+    if (rayIdx < 0) return -1;
+
+    int g = m_index->gateAt(m_data->at(rayIdx), dist);
+    if (g >= 0) {
+        double gd = m_data->at(rayIdx).gates[g].distance;
+        if (gd < m_minVisDist || gd > m_maxVisDist) g = -1; // 该门未绘制
     }
+    if (gate) *gate = g;
+    return rayIdx;
 }
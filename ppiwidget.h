@@ -2,42 +2,194 @@
 #define PPIWIDGET_H
 
 #include <QWidget>
+#include <QImage>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QPixmap>
+#include <functional>
 #include "datatypes.h"
+#include "ppirenderer.h"
+#include "timepyramid.h"
+#include "spatialindex.h"
+
+class PPIGLView;
+
+// 一帧的绘制统计
+struct PPIFrameStats {
+    double paintMs = 0.0;        // paintEvent / paintGL 用时（界面线程）
+    bool cacheHit = false;       // 直接贴缓存，本帧没有触发重新光栅化/上传
+    int overlayHits = 0;         // 叠加层位图复用/重画次数（累计）
+    int overlayMisses = 0;
+    int cacheHits = 0;           // 热力图缓存命中/未命中帧数（累计）
+    int cacheMisses = 0;
+    PPIRenderStats render;       // 最近一次光栅化的统计
+};
 
 class PPIWidget : public QWidget {
     Q_OBJECT
 public:
     explicit PPIWidget(QWidget *parent = nullptr);
+    ~PPIWidget();
     void setData(const ScanData* data);
     void setDisplayMode(DisplayMode mode);
+    // 每种模式各自的色标与值域（默认：经典色标，风速 ±10 m/s，湍流 0~0.5）
+    void setColorScale(DisplayMode mode, ColorMap::Palette palette, double lo, double hi);
+    const ColorMap& colorMap() const { return m_colors; }
+    ColorMap colorMap(DisplayMode mode) const;
+    // 直接采用外部建好的查找表，多个视图可共用同一张
+    void setColorMap(DisplayMode mode, const ColorMap& colors);
     void setPlayLimit(int limit);
      void setDistanceRange(double min, double max);
+    // 外部数据（过滤/湍流参数）变化后调用，触发重新光栅化
+    void refresh();
+
+    // 悬停/拾取使用的空间索引（随数据一起构建）
+    void setSpatialIndex(const PPISpatialIndex* index);
+
+    // 长时间数据：射线数超过预算时改用时间金字塔的概览层绘制
+    void setPyramid(const TimePyramid* pyramid);
+    void pyramidUpdated(); // 金字塔在后台重建完成
+    void setTimeWindow(const QDateTime& from, const QDateTime& to); // 无效时间表示不限制
+    void setRayRange(int begin, int end); // 只画 [begin, end) 的射线，如绑定到某个扫描；-1 表示不限制
+    void setRayMask(const QVector<bool>* mask); // 只画为 true 的射线（混合扫描时排除 RHI），空指针不限制
+    int currentLevel() const { return m_level; }
+
+    // 热力图后端：软件光栅化（默认）或 OpenGL 着色器
+    enum RenderBackend { Backend_Software, Backend_OpenGL };
+    void setRenderBackend(RenderBackend backend);
+    RenderBackend renderBackend() const { return m_glView ? Backend_OpenGL : Backend_Software; }
+
+    // 与其他视图共用像素查找表（小多图）
+    void setGeometryCache(const QSharedPointer<PPIGeometryCache>& cache) { m_renderer.setGeometryCache(cache); }
+
+    // 平移缩放状态，联动视图时在窗口之间同步
+    double viewScale() const { return m_scale; }
+    QPointF viewOffset() const { return m_offset; }
+    void setViewTransform(double scale, const QPointF& offset, bool interactive = false);
+
+    // 性能统计：左上角叠加显示，或由程序读取/导出
+    void setStatsOverlayVisible(bool on);
+    bool statsOverlayVisible() const { return m_showStats; }
+    PPIFrameStats frameStats() const { return m_frameStats; }
+    const FrameTimeHistogram& frameTimes() const { return m_frameTimes; }
+    void resetFrameStats();
+    // 导出最近若干帧的耗时直方图，文件头注明当前渲染方式
+    bool exportFrameTimesCsv(const QString& path) const;
 
 signals:
     void raySelected(int rayIndex);
+    // 悬停的射线变化时发出，移出有效区为 -1
+    void rayHovered(int rayIndex);
+    // OpenGL 不可用（版本过低/着色器失败/距离门不等间距）时自动退回软件渲染
+    void renderBackendFallback(const QString& reason);
+    // 用户拖拽/滚轮/双击复位改变了视图
+    void viewTransformChanged(double scale, const QPointF& offset);
 
 protected:
     void paintEvent(QPaintEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
     void mouseReleaseEvent(QMouseEvent *event) override;
+    void leaveEvent(QEvent *event) override;
     void wheelEvent(QWheelEvent *event) override;
      void mouseDoubleClickEvent(QMouseEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private slots:
+    void requestRender();
+    void onRenderFinished();
+    void onInteractionFinished();
 
 private:
-    void drawLegend(QPainter &p); // 新增：绘制图例
-    QColor valueToColor(double val);
-    QPointF polarToScreen(double azimuth, double distance, QPointF center);
+    friend class PPIGLView;
+    void drawOverlays(QPainter &p); // 刻度圈、图例等叠加层，两种后端共用
+    struct OverlayLayer {
+        QPixmap pixmap;
+        QString key; // 输入参数拼成的键，变化时才重画
+    };
+    const QPixmap& cachedLayer(OverlayLayer& layer, const QString& key, const QSize& size,
+                               const std::function<void(QPainter&)>& paint);
+    double pixelsPerMeter() const;
+    bool isCurrentJob(quint64 revision, quint64 colorSerial, DisplayMode mode) const {
+        return revision == m_dataRevision && colorSerial == m_colors.serial() && mode == m_mode;
+    }
+    PPIView makeView(bool withMargin = true);
+    void viewChanged(); // 视图变化：软件后端重绘，OpenGL 后端只更新 uniform
+    void fallbackToSoftware(const QString& reason);
+    void beginInteraction();
+    void recordFrame(double paintMs, bool cacheHit);
+    void drawStatsHud(QPainter &p);
+    const ScanData& raysToDraw(int& begin, int& end);
+    void visibleRayRange(int& begin, int& end) const;
+    void screenToPolar(const QPointF& pos, double& azimuth, double& distance) const;
+    int rayAtPosition(const QPointF& pos, int* gate = nullptr) const;
 
     const ScanData* m_data = nullptr;
     DisplayMode m_mode = Mode_Speed;
+    struct ColorScale { ColorMap::Palette palette; double lo, hi; };
+    ColorScale m_scales[2] = { {ColorMap::Palette_Classic, -10.0, 10.0}, {ColorMap::Palette_Classic, 0.0, 0.5} };
+    ColorMap m_colors;            // 当前模式的查找表，模式/色标变化时重建
     int m_playLimit = -1;
     double m_scale = 0.8;
     QPointF m_offset = QPointF(0, 0);
     QPoint m_lastMousePos;
     bool m_isDragging = false;
+    int m_hoverRay = -1;
     double m_minVisDist = 0.0;
     double m_maxVisDist = 10000.0;
+
+    const PPISpatialIndex* m_index = nullptr;
+
+    // 时间金字塔
+    const TimePyramid* m_pyramid = nullptr;
+    QDateTime m_winFrom, m_winTo;
+    int m_rangeBegin = -1, m_rangeEnd = -1;
+    const QVector<bool>* m_rayMask = nullptr;
+    int m_maxRaysPerFrame = 6000; // 超过此数改画概览
+    int m_maxMergeBuckets = 400;  // 概览合并的桶数上限，决定选用哪一层
+    int m_level = 0;              // 当前绘制所用的层（0 = 原始射线）
+    ScanData m_overview;          // 概览射线缓存
+    int m_ovLevel = -1;
+    qint64 m_ovT0 = 0, m_ovT1 = 0;
+    quint64 m_ovRevision = 0;
+
+    // 离屏热力图缓存
+    PPIRenderer m_renderer;
+    quint64 m_dataRevision = 0;   // refresh() 时递增，通知光栅化器重建极坐标网格
+    static constexpr double CacheMargin = 0.25; // 缓存图四周比窗口多出的比例
+    QImage m_cache;
+    QPointF m_cacheOrigin;        // 缓存图中雷达中心的位置
+    double m_cachePxPerM = 1.0;   // 缓存渲染时的比例尺
+    bool m_cacheDirty = true;     // 数据/模式/色标变化，需要重新光栅化
+    QFutureWatcher<QImage>* m_renderWatcher;
+    bool m_renderPending = false;
+    QPointF m_jobOrigin;          // 正在后台渲染的那一帧的几何参数
+    double m_jobPxPerM = 1.0;
+    quint64 m_jobRevision = 0;    // 后台那一帧画的是哪版数据/色标/模式；完成时与当前不符就丢掉
+    quint64 m_jobColorSerial = 0;
+    DisplayMode m_jobMode = Mode_Speed;
+    QTimer* m_settleTimer;        // 交互停止后触发重绘
+
+    // 交互画质策略：拖拽/滚轮期间关抗锯齿、按 1/DraftFactor 分辨率出草图，
+    // 停手 m_refineTimer 之后再恢复全画质
+    static constexpr int DraftFactor = 2;
+    bool m_interacting = false;
+    bool m_cacheDraft = false;    // 当前缓存是草图
+    bool m_jobDraft = false;
+    QTimer* m_refineTimer;
+
+    // 静态叠加层：刻度圈、图例、概览标签各缓存一张透明位图，合成在热力图之上
+    static constexpr int MaxRingLayer = 4096; // 刻度圈位图边长上限 (像素)，放得更大时直接画
+    OverlayLayer m_ringLayer;
+    OverlayLayer m_legendLayer;
+    OverlayLayer m_labelLayer;
+
+    // 性能统计
+    bool m_showStats = false;
+    PPIFrameStats m_frameStats;
+    FrameTimeHistogram m_frameTimes;
+
+    PPIGLView* m_glView = nullptr; // 非空即使用 OpenGL 后端
 };
 
 #endif // PPIWIDGET_H
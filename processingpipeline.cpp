@@ -0,0 +1,132 @@
+#include "processingpipeline.h"
+#include <cmath>
+#include <algorithm>
+
+ProcessingPipeline::ProcessingPipeline(int maxCacheKB) : m_cache(maxCacheKB) {}
+
+void ProcessingPipeline::setSource(const ScanData &raw) {
+    m_source = raw;
+    m_compactSource.clear();
+    m_compact = false;
+    m_sourceVersion++;
+    m_cache.clear(); // 旧版本的结果再也不会被命中，直接释放
+}
+
+void ProcessingPipeline::setSource(const CompactScanData &raw) {
+    m_compactSource = raw;
+    m_source.clear();
+    m_compact = true;
+    m_sourceVersion++;
+    m_cache.clear();
+}
+
+StageKey ProcessingPipeline::keyFor(Stage stage, const PipelineParams &p) const {
+    StageKey k{m_sourceVersion, stage, p.snrThreshold, 0.0, 0};
+    if (stage >= Stage_Outlier) k.outlierThreshold = (p.outlierThreshold > 0) ? p.outlierThreshold : 0.0;
+    if (stage >= Stage_Turbulence) k.windowSize = std::max(2, p.windowSize);
+    return k;
+}
+
+int ProcessingPipeline::costKB(const ScanData &data) {
+    qint64 bytes = qint64(data.size()) * sizeof(RadarRay);
+    for (const auto& r : data) bytes += qint64(r.gates.size()) * sizeof(RangeGate);
+    return int(bytes / 1024) + 1;
+}
+
+// ---------------------------------------------------------
+// 运行处理链：从最下游往回找最近的缓存命中，只计算其后的阶段
+// ---------------------------------------------------------
+ScanData ProcessingPipeline::run(const PipelineParams &params) {
+    StageKey keys[StageCount];
+    for (int s = 0; s < StageCount; ++s) keys[s] = keyFor(Stage(s), params);
+
+    ScanData data;
+    int start = 0;
+    for (int s = StageCount - 1; s >= 0; --s) {
+        if (ScanData* cached = m_cache.object(keys[s])) {
+            data = *cached;
+            start = s + 1;
+            m_hits[s]++;
+            break;
+        }
+    }
+    if (start == 0) data = m_compact ? m_compactSource.toScan() : m_source;
+
+    for (int s = start; s < StageCount; ++s) {
+        int cost = 1; // 直通阶段与上游共享内存，几乎不占额外空间
+        switch (s) {
+        case Stage_Filter:
+            filterStage(data, params.snrThreshold);
+            cost = costKB(data);
+            break;
+        case Stage_Outlier:
+            if (keys[s].outlierThreshold > 0) {
+                outlierStage(data, keys[s].outlierThreshold);
+                cost = costKB(data);
+            }
+            break;
+        case Stage_Turbulence:
+            turbulenceStage(data, keys[s].windowSize);
+            cost = costKB(data);
+            break;
+        }
+        m_computed[s]++;
+        m_cache.insert(keys[s], new ScanData(data), cost);
+    }
+    return data;
+}
+
+// 1. SNR 阈值过滤
+void ProcessingPipeline::filterStage(ScanData &data, double snrThreshold) {
+    for (auto &r : data) {
+        for (auto &g : r.gates) {
+            g.isValid = !(g.snr < snrThreshold);
+        }
+    }
+}
+
+// 2. 野值修复：与相邻有效门的均值相差超过阈值的点，用该均值替换
+void ProcessingPipeline::outlierStage(ScanData &data, double diffThreshold) {
+    for (auto &ray : data) {
+        int cnt = ray.gates.size();
+        if (cnt < 2) continue;
+        QVector<double> orig(cnt);
+        for (int i = 0; i < cnt; ++i) orig[i] = ray.gates[i].speed;
+
+        for (int i = 0; i < cnt; ++i) {
+            if (!ray.gates[i].isValid) continue;
+            double sum = 0; int n = 0;
+            if (i > 0 && ray.gates[i-1].isValid) { sum += orig[i-1]; n++; }
+            if (i < cnt - 1 && ray.gates[i+1].isValid) { sum += orig[i+1]; n++; }
+            if (n == 0) continue;
+            double ref = sum / n;
+            if (std::abs(orig[i] - ref) > diffThreshold) ray.gates[i].speed = ref;
+        }
+    }
+}
+
+// 3. 湍流强度计算 (滑动窗口)
+void ProcessingPipeline::turbulenceStage(ScanData &data, int windowSize) {
+    if (windowSize < 2) windowSize = 2;
+    int halfWin = windowSize / 2;
+    for (auto &ray : data) {
+        int cnt = ray.gates.size();
+        QVector<double> ti(cnt, 0.0);
+        for (int i = 0; i < cnt; ++i) {
+            if (!ray.gates[i].isValid) continue;
+            int start = std::max(0, i - halfWin);
+            int end = std::min(cnt - 1, i + halfWin);
+            double sum = 0, ss = 0; int n = 0;
+            for (int k = start; k <= end; ++k) {
+                if (ray.gates[k].isValid) { sum += ray.gates[k].speed; n++; }
+            }
+            if (n < 2) continue;
+            double mean = sum / n;
+            for (int k = start; k <= end; ++k) {
+                if (ray.gates[k].isValid) ss += std::pow(ray.gates[k].speed - mean, 2);
+            }
+            ti[i] = (std::abs(mean) > 0.01) ? (std::sqrt(ss/n) / std::abs(mean)) : 0.0;
+        }
+        for (int i = 0; i < cnt; ++i) ray.gates[i].turbulence = ti[i];
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef PROCESSINGPIPELINE_H
+#define PROCESSINGPIPELINE_H
+
+#include "datatypes.h"
+#include "compactscan.h"
+#include <QCache>
+#include <QHashFunctions>
+
+// 处理参数：每个阶段只关心自己的那一项
+struct PipelineParams {
+    double snrThreshold = -20.0;   // 阶段1：SNR 过滤阈值
+    double outlierThreshold = 0.0; // 阶段2：野值修复阈值 (<=0 表示关闭)
+    int windowSize = 5;            // 阶段3：湍流滑动窗口
+};
+
+// 缓存键：输入版本 + 到当前阶段为止的全部参数（下游参数置零）
+struct StageKey {
+    quint64 version;
+    int stage;
+    double snrThreshold;
+    double outlierThreshold;
+    int windowSize;
+
+    bool operator==(const StageKey& o) const {
+        return version == o.version && stage == o.stage
+               && snrThreshold == o.snrThreshold
+               && outlierThreshold == o.outlierThreshold
+               && windowSize == o.windowSize;
+    }
+};
+
+inline size_t qHash(const StageKey& k, size_t seed = 0) {
+    return qHashMulti(seed, k.version, k.stage, k.snrThreshold, k.outlierThreshold, k.windowSize);
+}
+
+// 显式处理链：原始数据 → SNR过滤 → 野值修复 → 湍流计算
+// 每个阶段的输出以 (输入版本, 本阶段及上游参数) 为键缓存在有内存上限的 QCache 中，
+// 修改下游参数不会重算上游，回退到最近用过的参数直接命中缓存。
+class ProcessingPipeline
+{
+public:
+    enum Stage {
+        Stage_Filter,
+        Stage_Outlier,
+        Stage_Turbulence,
+        StageCount
+    };
+
+    static constexpr int DefaultCacheKB = 256 * 1024;
+
+    explicit ProcessingPipeline(int maxCacheKB = DefaultCacheKB);
+
+    // 设置原始数据（版本号 +1，旧缓存随之失效）
+    void setSource(const ScanData& raw);
+    // 紧凑存储模式：原始数据以定点数保存，第一阶段运行时才解码
+    void setSource(const CompactScanData& raw);
+    bool isCompactSource() const { return m_compact; }
+    quint64 sourceVersion() const { return m_sourceVersion; }
+
+    // 运行整条处理链，返回最终结果（隐式共享，拷贝代价很小）
+    ScanData run(const PipelineParams& params);
+
+    void setMaxCacheKB(int kb) { m_cache.setMaxCost(kb); }
+    int maxCacheKB() const { return int(m_cache.maxCost()); }
+    void clearCache() { m_cache.clear(); }
+    // 缓存中各阶段副本的估算占用；最后一阶段与当前展示数据隐式共享时会偏大
+    qint64 cacheBytes() const { return qint64(m_cache.totalCost()) * 1024; }
+
+    // 统计：每个阶段实际计算的次数 / 命中缓存的次数
+    int computeCount(Stage s) const { return m_computed[s]; }
+    int hitCount(Stage s) const { return m_hits[s]; }
+
+    // 各阶段的具体实现（原地修改）
+    static void filterStage(ScanData& data, double snrThreshold);
+    static void outlierStage(ScanData& data, double diffThreshold);
+    static void turbulenceStage(ScanData& data, int windowSize);
+
+private:
+    StageKey keyFor(Stage stage, const PipelineParams& p) const;
+    static int costKB(const ScanData& data);
+
+    ScanData m_source;
+    CompactScanData m_compactSource;
+    bool m_compact = false;
+    quint64 m_sourceVersion = 0;
+    QCache<StageKey, ScanData> m_cache; // 成本单位：KB
+    int m_computed[StageCount] = {0, 0, 0};
+    int m_hits[StageCount] = {0, 0, 0};
+};
+
+#endif // PROCESSINGPIPELINE_H
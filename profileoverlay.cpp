@@ -0,0 +1,127 @@
+#include "profileoverlay.h"
+
+ProfileOverlay::ProfileOverlay(QCPAxis *keyAxis, QCPAxis *valueAxis) : QCPAbstractPlottable(keyAxis, valueAxis) {
+    setSelectable(QCP::stNone);
+    setAntialiased(false);
+
+    // 时间色表只建一次
+    QCPColorGradient gradient(QCPColorGradient::gpJet); // 早蓝晚红
+    m_colors.resize(256);
+    for (int i = 0; i < 256; ++i) {
+        QRgb c = gradient.color(i, QCPRange(0, 255));
+        m_colors[i] = qRgba(qRed(c), qGreen(c), qBlue(c), 150);
+    }
+}
+
+void ProfileOverlay::setSource(const ScanData *data, int begin, int end) {
+    m_data = data;
+    m_begin = data ? qBound(0, begin, int(data->size())) : 0;
+    m_end = data ? qBound(m_begin, end, int(data->size())) : 0;
+
+    // 颜色按时间在窗口内的位置
+    m_colorIdx.clear();
+    if (m_end > m_begin) {
+        const qint64 t0 = m_data->at(m_begin).timestamp.toMSecsSinceEpoch();
+        const qint64 span = qMax<qint64>(1, m_data->at(m_end - 1).timestamp.toMSecsSinceEpoch() - t0);
+        for (int i = m_begin; i < m_end; i += stride()) {
+            qint64 t = m_data->at(i).timestamp.toMSecsSinceEpoch() - t0;
+            m_colorIdx << uchar(qBound<qint64>(0, t * 255 / span, 255));
+        }
+    }
+    m_rangeDirty = true;
+}
+
+void ProfileOverlay::setMode(DisplayMode mode) {
+    if (mode == m_mode) return;
+    m_mode = mode;
+    m_rangeDirty = true;
+}
+
+void ProfileOverlay::setOffset(double offset) {
+    m_offset = offset;
+    m_rangeDirty = true;
+}
+
+void ProfileOverlay::setDistanceRange(double min, double max) {
+    m_minDist = min;
+    m_maxDist = max;
+    m_rangeDirty = true;
+}
+
+int ProfileOverlay::curveCount() const {
+    return m_colorIdx.size();
+}
+
+void ProfileOverlay::updateRanges() const {
+    if (!m_rangeDirty) return;
+    m_rangeDirty = false;
+    m_hasRange = false;
+    if (!m_data) return;
+    const int step = stride();
+    int k = 0;
+    for (int i = m_begin; i < m_end; i += step, ++k) {
+        const double shift = k * m_offset;
+        for (const RangeGate &g : m_data->at(i).gates) {
+            if (!g.isValid || g.distance < m_minDist || g.distance > m_maxDist) continue;
+            const double key = fieldOf(g) + shift;
+            if (!m_hasRange) {
+                m_keyRange = QCPRange(key, key);
+                m_valueRange = QCPRange(g.distance, g.distance);
+                m_hasRange = true;
+            } else {
+                m_keyRange.expand(key);
+                m_valueRange.expand(g.distance);
+            }
+        }
+    }
+}
+
+double ProfileOverlay::selectTest(const QPointF &, bool, QVariant *) const {
+    return -1; // 只用于查看，不参与选择
+}
+
+QCPRange ProfileOverlay::getKeyRange(bool &foundRange, QCP::SignDomain) const {
+    updateRanges();
+    foundRange = m_hasRange;
+    return m_keyRange;
+}
+
+QCPRange ProfileOverlay::getValueRange(bool &foundRange, QCP::SignDomain, const QCPRange &) const {
+    updateRanges();
+    foundRange = m_hasRange;
+    return m_valueRange;
+}
+
+void ProfileOverlay::draw(QCPPainter *painter) {
+    if (!m_data || m_end <= m_begin) return;
+    QCPAxis *keyAxis = mKeyAxis.data();
+    QCPAxis *valueAxis = mValueAxis.data();
+    if (!keyAxis || !valueAxis) return;
+
+    applyDefaultAntialiasingHint(painter);
+    QPen pen(QColor(0, 0, 0), 1);
+    pen.setCosmetic(true);
+    const int step = stride();
+    int k = 0;
+    for (int i = m_begin; i < m_end; i += step, ++k) {
+        const double shift = k * m_offset;
+        m_points.clear();
+        for (const RangeGate &g : m_data->at(i).gates) {
+            if (!g.isValid || g.distance < m_minDist || g.distance > m_maxDist) continue;
+            m_points.append(coordsToPixels(fieldOf(g) + shift, g.distance));
+        }
+        if (m_points.size() < 2) continue;
+        pen.setColor(QColor::fromRgba(m_colors[m_colorIdx[k]]));
+        painter->setPen(pen);
+        painter->drawPolyline(m_points.constData(), m_points.size());
+    }
+}
+
+void ProfileOverlay::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const {
+    // 几条由蓝到红的短线
+    for (int i = 0; i < 4; ++i) {
+        painter->setPen(QPen(QColor::fromRgba(m_colors[i * 85]), 1));
+        double y = rect.top() + rect.height() * (i + 1) / 5.0;
+        painter->drawLine(QLineF(rect.left(), y, rect.right(), y));
+    }
+}
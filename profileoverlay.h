@@ -0,0 +1,57 @@
+#ifndef PROFILEOVERLAY_H
+#define PROFILEOVERLAY_H
+
+#include "datatypes.h"
+#include "qcustomplot.h"
+
+// 多条距离廓线叠画（瀑布图）：一个 plottable 画一整个 sweep / 时间窗的所有射线，
+// 直接读 ScanData，不为每条射线建 QCPCurve，也不复制数据。
+//  - 一次 draw 里逐条描折线，复用同一个点缓冲
+//  - 颜色按射线时间在窗口内的位置查预先算好的 256 级色表
+//  - offset 不为 0 时第 k 条廓线沿数值轴错开 k*offset，成为瀑布图
+// 键轴为数值（风速/湍流），值轴为距离，与 m_speedCurve 一致
+class ProfileOverlay : public QCPAbstractPlottable
+{
+    Q_OBJECT
+public:
+    ProfileOverlay(QCPAxis* keyAxis, QCPAxis* valueAxis);
+
+    void setSource(const ScanData* data, int begin, int end);
+    void setMode(DisplayMode mode);
+    void setOffset(double offset);
+    void setDistanceRange(double min, double max);
+
+    int curveCount() const;
+
+    double selectTest(const QPointF& pos, bool onlySelectable, QVariant* details = nullptr) const override;
+    QCPRange getKeyRange(bool& foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth) const override;
+    QCPRange getValueRange(bool& foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth,
+                           const QCPRange& inKeyRange = QCPRange()) const override;
+
+protected:
+    void draw(QCPPainter* painter) override;
+    void drawLegendIcon(QCPPainter* painter, const QRectF& rect) const override;
+
+private:
+    void updateRanges() const;
+    int stride() const { return qMax(1, (m_end - m_begin + MaxCurves - 1) / MaxCurves); }
+    double fieldOf(const RangeGate& g) const { return m_mode == Mode_Turbulence ? g.turbulence : g.speed; }
+
+    const ScanData* m_data = nullptr;
+    int m_begin = 0, m_end = 0;
+    DisplayMode m_mode = Mode_Speed;
+    double m_offset = 0.0;
+    double m_minDist = 0.0, m_maxDist = 1e9;
+
+    QVector<QRgb> m_colors;     // 时间色表：早 -> 晚
+    QVector<uchar> m_colorIdx;  // 每条（抽样后的）廓线的色表下标
+    // 轴范围在第一次被询问时才算，连续调几个 setter 只遍历一次
+    mutable QCPRange m_keyRange, m_valueRange;
+    mutable bool m_hasRange = false;
+    mutable bool m_rangeDirty = true;
+    QVector<QPointF> m_points;  // 描线缓冲，draw 之间复用
+
+    static constexpr int MaxCurves = 1000; // 超过时等间隔抽样，画多了也分不清
+};
+
+#endif // PROFILEOVERLAY_H
@@ -0,0 +1,81 @@
+#include "renderstats.h"
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+
+FrameTimeHistogram::FrameTimeHistogram(int capacity) {
+    m_samples.resize(std::max(1, capacity));
+}
+
+void FrameTimeHistogram::add(double ms) {
+    m_samples[m_next] = float(ms);
+    if (++m_next == m_samples.size()) {
+        m_next = 0;
+        m_full = true;
+    }
+}
+
+void FrameTimeHistogram::clear() {
+    m_next = 0;
+    m_full = false;
+}
+
+QVector<double> FrameTimeHistogram::samples() const {
+    QVector<double> out;
+    out.reserve(count());
+    if (m_full)
+        for (int i = m_next; i < m_samples.size(); ++i) out << m_samples[i];
+    for (int i = 0; i < m_next; ++i) out << m_samples[i];
+    return out;
+}
+
+double FrameTimeHistogram::mean() const {
+    int n = count();
+    if (n == 0) return 0.0;
+    double sum = 0;
+    for (int i = 0; i < n; ++i) sum += m_samples[i];
+    return sum / n;
+}
+
+double FrameTimeHistogram::percentile(double p) const {
+    QVector<double> s = samples();
+    if (s.isEmpty()) return 0.0;
+    int k = qBound(0, int(p * (s.size() - 1) + 0.5), int(s.size()) - 1);
+    std::nth_element(s.begin(), s.begin() + k, s.end());
+    return s[k];
+}
+
+QVector<int> FrameTimeHistogram::histogram(double binMs, int bins) const {
+    QVector<int> h(bins, 0);
+    int n = count();
+    for (int i = 0; i < n; ++i) {
+        int b = int(m_samples[i] / binMs);
+        h[std::min(std::max(b, 0), bins - 1)]++;
+    }
+    return h;
+}
+
+bool FrameTimeHistogram::exportCsv(const QString &path, const QString &label) const {
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    QTextStream out(&f);
+
+    // 头部：渲染方式与汇总，方便多份文件并排比较
+    out << "# renderer," << label << "\n";
+    out << "# samples," << count() << "\n";
+    out << "# mean_ms," << mean() << "\n";
+    out << "# p50_ms," << percentile(0.5) << "\n";
+    out << "# p95_ms," << percentile(0.95) << "\n";
+    out << "bin_start_ms,bin_end_ms,count\n";
+
+    const double binMs = 1.0;
+    const int bins = 101; // 0~100 ms，最后一桶为 >=100 ms
+    QVector<int> h = histogram(binMs, bins);
+    for (int b = 0; b < bins; ++b) {
+        out << b * binMs << ",";
+        if (b == bins - 1) out << "inf";
+        else out << (b + 1) * binMs;
+        out << "," << h[b] << "\n";
+    }
+    return true;
+}
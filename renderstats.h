@@ -0,0 +1,49 @@
+#ifndef RENDERSTATS_H
+#define RENDERSTATS_H
+
+#include <QVector>
+#include <QString>
+
+// 一次 PPIRenderer::render 的统计（预览 + 全分辨率两遍累加）
+struct PPIRenderStats {
+    double totalMs = 0.0;
+    double traversalMs = 0.0;  // 遍历射线与距离门（含裁剪判断、合并求均值）
+    double colorMs = 0.0;      // 查色标（只在分段计时时单独统计，否则算在遍历里）
+    double rasterMs = 0.0;     // 写网格 + 像素查找表 + 像素填充
+    int raysStamped = 0;       // 写入网格的射线
+    int raysCulled = 0;        // 扇区在视口外被跳过的射线
+    qint64 cellsWritten = 0;   // 写入网格的单元数（相当于原来提交的扇形多边形数）
+    qint64 gatesCulled = 0;    // 视口裁剪省掉的距离门
+    qint64 gatesMerged = 0;    // 细节层次合并掉的距离门
+    qint64 pixelsFilled = 0;
+    bool gridHit = false;      // 极坐标网格沿用（含播放时的增量补写）
+    bool lutHit = false;       // 像素查找表沿用
+    bool incremental = false;  // 只重填了脏矩形
+};
+
+// 最近 N 帧的耗时，滚动保存；可以导出为按毫秒分桶的直方图 CSV，
+// 用来在不同数据集上对比软件/OpenGL 等渲染方式
+class FrameTimeHistogram
+{
+public:
+    explicit FrameTimeHistogram(int capacity = 600);
+
+    void add(double ms);
+    void clear();
+    int count() const { return m_full ? m_samples.size() : m_next; }
+    QVector<double> samples() const; // 从旧到新
+
+    double mean() const;
+    double percentile(double p) const; // p: 0~1
+    // 以 binMs 为宽度分 bins 个桶，最后一个桶收所有更慢的帧
+    QVector<int> histogram(double binMs, int bins) const;
+
+    bool exportCsv(const QString& path, const QString& label) const;
+
+private:
+    QVector<float> m_samples;
+    int m_next = 0;
+    bool m_full = false;
+};
+
+#endif // RENDERSTATS_H
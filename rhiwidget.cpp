@@ -0,0 +1,512 @@
+#include "rhiwidget.h"
+#include "ppirenderer.h"
+#include <QPainter>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QToolTip>
+#include <QComboBox>
+#include <QtConcurrent>
+#include <QtMath>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+RHIWidget::RHIWidget(QWidget *parent) : QWidget(parent) {
+    setMouseTracking(true);
+    setAttribute(Qt::WA_StyledBackground, true);
+    setMinimumWidth(240);
+
+    // 缩放停下后再看要不要按新分辨率重画
+    m_settleTimer = new QTimer(this);
+    m_settleTimer->setSingleShot(true);
+    m_settleTimer->setInterval(150);
+    connect(m_settleTimer, &QTimer::timeout, this, [this]() { update(); });
+
+    m_sweepBox = new QComboBox(this);
+    m_sweepBox->setFocusPolicy(Qt::NoFocus);
+    connect(m_sweepBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int i) {
+        m_selected = i - 1; // 第 0 项为跟随回放
+        update();
+    });
+    rebuildSweepBox();
+}
+
+void RHIWidget::setData(const ScanData *data, const SweepList *sweeps) {
+    m_data = data;
+    m_sweeps = sweeps;
+    m_rhi.clear();
+    if (m_sweeps) {
+        for (int i = 0; i < m_sweeps->size(); ++i)
+            if (m_sweeps->at(i).type == Scan_RHI) m_rhi << i;
+    }
+    m_selected = -1;
+    m_playLimit = -1;
+    m_scale = 1.0;
+    m_offset = QPointF(0, 0);
+    m_beamSweep = -1;
+    m_raster = Raster();
+    rebuildSweepBox();
+    emit availabilityChanged(hasRhi());
+    update();
+}
+
+void RHIWidget::setDisplayMode(DisplayMode mode) {
+    m_mode = mode;
+    update();
+}
+
+void RHIWidget::setColorMap(DisplayMode mode, const ColorMap &colors) {
+    m_colors[mode == Mode_Turbulence ? 1 : 0] = colors;
+    update();
+}
+
+void RHIWidget::setDistanceRange(double min, double max) {
+    m_minDist = min;
+    m_maxDist = max;
+    update();
+}
+
+void RHIWidget::setPlayLimit(int limit) {
+    if (limit == m_playLimit) return;
+    m_playLimit = limit;
+    if (m_selected < 0 && isVisible()) update();
+}
+
+void RHIWidget::refresh() {
+    m_revision++;
+    update();
+}
+
+void RHIWidget::setSweep(int rhiIndex) {
+    m_sweepBox->setCurrentIndex(qBound(-1, rhiIndex, int(m_rhi.size()) - 1) + 1);
+}
+
+void RHIWidget::rebuildSweepBox() {
+    QSignalBlocker block(m_sweepBox);
+    m_sweepBox->clear();
+    m_sweepBox->addItem("跟随回放");
+    for (int k = 0; k < m_rhi.size(); ++k) {
+        const SweepInfo &s = m_sweeps->at(m_rhi[k]);
+        m_sweepBox->addItem(QString("RHI %1  %2  方位 %3°").arg(k + 1)
+                                .arg(m_data->at(s.firstRay).timestamp.toString("HH:mm:ss"))
+                                .arg(s.azimuth, 0, 'f', 1));
+    }
+    m_sweepBox->adjustSize();
+    m_sweepBox->move(8, 4);
+}
+
+// 当前显示的扫描（m_sweeps 下标）及要画到的射线 end；跟随回放时取播放位置之前最近开始的 RHI
+int RHIWidget::currentSweep(int &end) const {
+    end = 0;
+    if (m_rhi.isEmpty() || !m_data) return -1;
+    int s = -1;
+    if (m_selected >= 0) {
+        s = m_rhi[m_selected];
+    } else {
+        const int limit = m_playLimit < 0 ? int(m_data->size()) : m_playLimit;
+        for (int k : m_rhi) {
+            if (m_sweeps->at(k).firstRay >= limit) break;
+            s = k;
+        }
+        if (s < 0) return -1;
+    }
+    const SweepInfo &info = m_sweeps->at(s);
+    end = info.firstRay + info.rayCount;
+    if (m_selected < 0 && m_playLimit >= 0) end = qMin(end, m_playLimit);
+    return s;
+}
+
+// 射线按仰角排序，半宽取相邻仰角差中位数的 0.6 倍，略有重叠免得出现缝
+void RHIWidget::prepareBeams(int sweep, int end) {
+    if (sweep == m_beamSweep && end == m_beamEnd && m_revision == m_beamRevision) return;
+    const SweepInfo &info = m_sweeps->at(sweep);
+    if (sweep != m_beamSweep || m_revision != m_beamRevision) {
+        m_edges.clear();
+        for (const auto &g : m_data->at(info.firstRay).gates) m_edges << g.distance;
+    }
+    m_beamSweep = sweep;
+    m_beamEnd = end;
+    m_beamRevision = m_revision;
+
+    m_beams.clear();
+    for (int i = info.firstRay; i < end; ++i) m_beams.append({ m_data->at(i).elevation, i });
+    std::sort(m_beams.begin(), m_beams.end(), [](const Beam &a, const Beam &b) { return a.elevation < b.elevation; });
+
+    // 半宽按整个扫描算，回放过程中不跟着变
+    QVector<double> els, steps;
+    for (int i = info.firstRay; i < info.firstRay + info.rayCount; ++i) els << m_data->at(i).elevation;
+    std::sort(els.begin(), els.end());
+    for (int i = 1; i < els.size(); ++i)
+        if (els[i] - els[i - 1] > 1e-6) steps << els[i] - els[i - 1];
+    if (!steps.isEmpty()) {
+        std::nth_element(steps.begin(), steps.begin() + steps.size() / 2, steps.end());
+        m_halfWidth = qBound(0.05, 0.6 * steps[steps.size() / 2], 2.0);
+    } else {
+        m_halfWidth = 0.5;
+    }
+}
+
+int RHIWidget::beamAt(double elevation) const {
+    if (m_beams.isEmpty()) return -1;
+    auto it = std::lower_bound(m_beams.begin(), m_beams.end(), elevation,
+                               [](const Beam &b, double e) { return b.elevation < e; });
+    int k = int(it - m_beams.begin());
+    int best = -1;
+    double bestDiff = m_halfWidth;
+    for (int c : { k - 1, k }) {
+        if (c < 0 || c >= m_beams.size()) continue;
+        double d = std::abs(m_beams[c].elevation - elevation);
+        if (d <= bestDiff) { bestDiff = d; best = c; }
+    }
+    return best;
+}
+
+// 整个扫描（不只是已回放部分）覆盖的剖面范围，回放时视图不跳
+QRectF RHIWidget::worldBox() const {
+    double R = m_maxDist;
+    if (!m_edges.isEmpty()) R = qMin(R, double(m_edges.last()));
+    R = qMax(R, 100.0);
+    double x0 = 0, x1 = 0, y1 = 0;
+    if (m_beamSweep >= 0) {
+        const SweepInfo &info = m_sweeps->at(m_beamSweep);
+        for (int i = info.firstRay; i < info.firstRay + info.rayCount; ++i) {
+            double el = qDegreesToRadians(m_data->at(i).elevation);
+            x0 = qMin(x0, R * std::cos(el));
+            x1 = qMax(x1, R * std::cos(el));
+            y1 = qMax(y1, R * std::sin(el));
+        }
+    }
+    if (x1 - x0 < R * 0.1) x1 = x0 + R * 0.1;
+    y1 = qMax(y1, R * 0.1);
+    return QRectF(x0, 0, x1 - x0, y1); // y 向上
+}
+
+double RHIWidget::pxPerMeter() const {
+    QRectF area = QRectF(rect()).adjusted(MarginLeft, MarginTop, -MarginRight, -MarginBottom);
+    QRectF box = worldBox();
+    if (area.width() <= 0 || area.height() <= 0) return 0.0;
+    return qMin(area.width() / box.width(), area.height() / box.height()) * m_scale;
+}
+
+// 绘图区中心对齐剖面中心，再叠加平移
+QPointF RHIWidget::worldOrigin() const {
+    QRectF area = QRectF(rect()).adjusted(MarginLeft, MarginTop, -MarginRight, -MarginBottom);
+    QRectF box = worldBox();
+    double ppm = pxPerMeter();
+    return area.center() + m_offset - QPointF(box.center().x() * ppm, -box.center().y() * ppm);
+}
+
+QPointF RHIWidget::toScreen(double x, double y) const {
+    double ppm = pxPerMeter();
+    QPointF o = worldOrigin();
+    return QPointF(o.x() + x * ppm, o.y() - y * ppm);
+}
+
+QPointF RHIWidget::toWorld(const QPointF &pos) const {
+    double ppm = pxPerMeter();
+    QPointF o = worldOrigin();
+    if (ppm <= 0) return QPointF();
+    return QPointF((pos.x() - o.x()) / ppm, (o.y() - pos.y()) / ppm);
+}
+
+// ---------------------------------------------------------
+// 栅格：先查好每条射线每个门的颜色，再逐像素反算 (仰角, 斜距)
+// ---------------------------------------------------------
+void RHIWidget::ensureRaster() {
+    int end;
+    int sweep = currentSweep(end);
+    if (sweep < 0) {
+        m_raster = Raster();
+        return;
+    }
+    prepareBeams(sweep, end);
+
+    const ColorMap &colors = m_colors[m_mode == Mode_Turbulence ? 1 : 0];
+    const QRectF box = worldBox();
+    const double ppm = pxPerMeter();
+    const double cap = MaxRasterSide / qMax(box.width(), box.height());
+    const double want = qMin(ppm, cap);
+
+    const bool same = m_raster.sweep == sweep && m_raster.mode == m_mode && !m_raster.image.isNull()
+                      && m_raster.colorSerial == colors.serial() && m_raster.minDist == m_minDist
+                      && m_raster.maxDist == m_maxDist && m_raster.revision == m_revision && m_raster.world == box;
+    // 参数没变时只在放大到明显发虚、且已经停手时才提高分辨率；缩小时沿用旧图
+    const bool keepRes = same && (m_settleTimer->isActive() || want <= m_raster.pxPerM * 2.0);
+    if (keepRes && end == m_raster.end) return;
+    if (want <= 0) return;
+    // 跟随回放时扫描每帧只多几条射线：沿用旧图，只重画新射线可能占到的那一段仰角扇区
+    const bool grow = keepRes && end > m_raster.end;
+    const double res = grow ? m_raster.pxPerM : want;
+
+    const int gates = qMax(0, int(m_edges.size()) - 1);
+    const int beams = m_beams.size();
+    QVector<QRgb> cells(qsizetype(beams) * gates, 0);
+    const QRgb invalid = qRgb(240, 240, 240);
+    for (int k = 0; k < beams; ++k) {
+        const RadarRay &ray = m_data->at(m_beams[k].ray);
+        const int n = qMin(gates, int(ray.gates.size()));
+        QRgb *row = cells.data() + qsizetype(k) * gates;
+        for (int j = 0; j < n; ++j) {
+            const RangeGate &g = ray.gates[j];
+            if (g.distance < m_minDist || g.distance > m_maxDist) continue;
+            if (!g.isValid) row[j] = invalid;
+            else row[j] = colors.premultiplied(m_mode == Mode_Speed ? g.speed : g.turbulence);
+        }
+    }
+
+    if (!grow) {
+        QSize size(qMax(1, qCeil(box.width() * res)), qMax(1, qCeil(box.height() * res)));
+        m_raster.image = QImage(size, QImage::Format_ARGB32_Premultiplied);
+        m_raster.image.fill(Qt::transparent);
+    }
+    QImage &img = m_raster.image;
+    img.bits(); // 先在主线程里确保独占，工作线程里的 scanLine 就不会各自 detach
+    const int cols = img.width();
+
+    // 新射线的仰角范围（各自再放宽半个波束宽），按行换算成要重画的列区间：
+    // 每行高度固定，仰角随水平距离单调减小，所以扇区在每一行里都是连续一段
+    double cotLo = 0.0, cotHi = 0.0;
+    bool dirty = !grow;
+    if (grow) {
+        double elLo = 180.0, elHi = 0.0;
+        for (int i = m_raster.end; i < end; ++i) {
+            elLo = qMin(elLo, m_data->at(i).elevation);
+            elHi = qMax(elHi, m_data->at(i).elevation);
+        }
+        const double lo = qDegreesToRadians(qMax(1e-3, elLo - m_halfWidth));
+        const double hi = qDegreesToRadians(qMin(180.0 - 1e-3, elHi + m_halfWidth));
+        dirty = lo < hi;
+        cotLo = std::cos(lo) / std::sin(lo);
+        cotHi = std::cos(hi) / std::sin(hi);
+    }
+
+    if (dirty && beams > 0 && gates > 0) {
+        QVector<int> rows(img.height());
+        std::iota(rows.begin(), rows.end(), 0);
+        const double rMin = m_edges.first(), rMax = m_edges.last();
+        const float *edges = m_edges.constData();
+        const QRgb *table = cells.constData();
+        QtConcurrent::blockingMap(rows, [&](int y) {
+            QRgb *line = reinterpret_cast<QRgb *>(img.scanLine(y));
+            const double wy = box.bottom() - (y + 0.5) / res; // QRectF 的 bottom 即世界坐标最高处
+            int x0 = 0, x1 = cols;
+            if (grow) {
+                x0 = qMax(0, int(std::floor((wy * cotHi - box.left()) * res)) - 1);
+                x1 = qMin(cols, int(std::ceil((wy * cotLo - box.left()) * res)) + 1);
+            }
+            for (int x = x0; x < x1; ++x) {
+                line[x] = 0;
+                const double wx = box.left() + (x + 0.5) / res;
+                const double r = std::hypot(wx, wy);
+                if (r < rMin || r >= rMax) continue;
+                int k = beamAt(qRadiansToDegrees(std::atan2(wy, wx)));
+                if (k < 0) continue;
+                int j = int(std::upper_bound(edges, edges + gates + 1, float(r)) - edges) - 1;
+                if (j >= 0 && j < gates) line[x] = table[qsizetype(k) * gates + j];
+            }
+        });
+    }
+
+    m_raster.world = box;
+    m_raster.pxPerM = res;
+    m_raster.sweep = sweep;
+    m_raster.end = end;
+    m_raster.mode = m_mode;
+    m_raster.colorSerial = colors.serial();
+    m_raster.minDist = m_minDist;
+    m_raster.maxDist = m_maxDist;
+    m_raster.revision = m_revision;
+}
+
+// 取一个 1-2-5 刻度间隔，使绘图区里大约有 target 条线
+static double niceStep(double span, int target) {
+    double raw = span / qMax(1, target);
+    double p = std::pow(10.0, std::floor(std::log10(raw)));
+    for (double m : { 1.0, 2.0, 5.0, 10.0 })
+        if (m * p >= raw) return m * p;
+    return 10 * p;
+}
+
+void RHIWidget::drawAxes(QPainter &p, const QRectF &area) {
+    const QPointF w0 = toWorld(area.bottomLeft()), w1 = toWorld(area.topRight());
+    p.save();
+    p.setClipRect(area);
+    p.setFont(QFont("Arial", 8));
+
+    // 水平距离与高度网格
+    QPen grid(QColor(0, 0, 0, 40), 1, Qt::DashLine);
+    p.setPen(grid);
+    double sx = niceStep(w1.x() - w0.x(), 6), sy = niceStep(w1.y() - w0.y(), 5);
+    for (double x = std::ceil(w0.x() / sx) * sx; x <= w1.x(); x += sx) {
+        double px = toScreen(x, 0).x();
+        p.drawLine(QPointF(px, area.top()), QPointF(px, area.bottom()));
+    }
+    for (double y = std::ceil(qMax(0.0, w0.y()) / sy) * sy; y <= w1.y(); y += sy) {
+        double py = toScreen(0, y).y();
+        p.drawLine(QPointF(area.left(), py), QPointF(area.right(), py));
+    }
+
+    // 每 15° 一条仰角辅助线，地面线加粗
+    const QPointF o = toScreen(0, 0);
+    const double R = (m_edges.isEmpty() ? m_maxDist : qMin(m_maxDist, double(m_edges.last()))) * pxPerMeter();
+    p.setPen(QPen(QColor(0, 0, 0, 30), 1));
+    for (int el = 15; el < 180; el += 15) {
+        double a = qDegreesToRadians(double(el));
+        p.drawLine(o, o + QPointF(R * std::cos(a), -R * std::sin(a)));
+    }
+    p.setPen(QPen(QColor(0, 0, 0, 120), 1));
+    p.drawLine(QPointF(area.left(), o.y()), QPointF(area.right(), o.y()));
+    p.restore();
+
+    // 刻度文字画在边距里
+    p.save();
+    p.setFont(QFont("Arial", 8));
+    p.setPen(Qt::darkGray);
+    for (double x = std::ceil(w0.x() / sx) * sx; x <= w1.x(); x += sx) {
+        double px = toScreen(x, 0).x();
+        p.drawText(QRectF(px - 30, area.bottom() + 2, 60, 14), Qt::AlignCenter, QString::number(x, 'f', 0));
+    }
+    for (double y = std::ceil(qMax(0.0, w0.y()) / sy) * sy; y <= w1.y(); y += sy) {
+        double py = toScreen(0, y).y();
+        p.drawText(QRectF(2, py - 7, MarginLeft - 6, 14), Qt::AlignRight | Qt::AlignVCenter, QString::number(y, 'f', 0));
+    }
+    p.drawText(QRectF(area.left(), area.bottom() + 16, area.width(), 16), Qt::AlignCenter, "水平距离 (m)");
+    p.translate(12, area.center().y());
+    p.rotate(-90);
+    p.drawText(QRectF(-60, -8, 120, 16), Qt::AlignCenter, "高度 (m)");
+    p.restore();
+}
+
+void RHIWidget::paintEvent(QPaintEvent *) {
+    QPainter p(this);
+    p.fillRect(rect(), Qt::white);
+    const QRectF area = QRectF(rect()).adjusted(MarginLeft, MarginTop, -MarginRight, -MarginBottom);
+
+    ensureRaster();
+    if (m_raster.sweep < 0) {
+        p.setPen(Qt::gray);
+        p.drawText(rect(), Qt::AlignCenter, hasRhi() ? "回放尚未到达 RHI 扫描" : "当前数据没有 RHI 扫描");
+        return;
+    }
+
+    // 缓存按世界坐标存放，平移缩放只是换一个目标矩形
+    const QRectF &w = m_raster.world;
+    QRectF target(toScreen(w.left(), w.bottom()), toScreen(w.right(), w.top()));
+    p.save();
+    p.setClipRect(area);
+    p.setRenderHint(QPainter::SmoothPixmapTransform, m_raster.pxPerM < pxPerMeter());
+    p.drawImage(target, m_raster.image);
+    p.restore();
+
+    drawAxes(p, area);
+
+    const ColorMap &colors = m_colors[m_mode == Mode_Turbulence ? 1 : 0];
+    QSize ls = PPIRenderer::legendSize();
+    p.save();
+    p.translate(width() - ls.width() - 8, height() - ls.height() - MarginBottom);
+    PPIRenderer::drawLegend(p, colors, m_mode);
+    p.restore();
+
+    const SweepInfo &info = m_sweeps->at(m_raster.sweep);
+    p.setPen(Qt::black);
+    p.drawText(QRectF(m_sweepBox->geometry().right() + 12, 4, width(), m_sweepBox->height()),
+               Qt::AlignLeft | Qt::AlignVCenter,
+               QString("RHI 扫描 %1   方位 %2°   %3").arg(m_rhi.indexOf(m_raster.sweep) + 1)
+                   .arg(info.azimuth, 0, 'f', 1)
+                   .arg(m_data->at(info.firstRay).timestamp.toString("yyyy-MM-dd HH:mm:ss")));
+}
+
+void RHIWidget::resizeEvent(QResizeEvent *e) {
+    QWidget::resizeEvent(e);
+    m_settleTimer->start();
+}
+
+// 鼠标下实际绘制的射线；gate 返回距离门号（未绘制的门为 -1）
+int RHIWidget::rayAtPosition(const QPointF &pos, int *gate) const {
+    if (gate) *gate = -1;
+    if (m_raster.sweep < 0 || m_beams.isEmpty()) return -1;
+    QPointF w = toWorld(pos);
+    if (w.y() < 0) return -1;
+    int k = beamAt(qRadiansToDegrees(std::atan2(w.y(), w.x())));
+    if (k < 0) return -1;
+    const int rayIdx = m_beams[k].ray;
+    const double r = std::hypot(w.x(), w.y());
+    int g = int(std::upper_bound(m_edges.begin(), m_edges.end(), float(r)) - m_edges.begin()) - 1;
+    if (g < 0 || g >= m_edges.size() - 1 || g >= m_data->at(rayIdx).gates.size()) return -1;
+    double gd = m_data->at(rayIdx).gates[g].distance;
+    if (gate && gd >= m_minDist && gd <= m_maxDist) *gate = g;
+    return rayIdx;
+}
+
+void RHIWidget::mousePressEvent(QMouseEvent *e) {
+    if (e->button() == Qt::LeftButton) {
+        m_dragging = true;
+        m_lastMousePos = e->pos();
+        setCursor(Qt::ClosedHandCursor);
+    }
+    int rayIdx = rayAtPosition(e->position());
+    if (rayIdx >= 0) emit raySelected(rayIdx);
+}
+
+void RHIWidget::mouseReleaseEvent(QMouseEvent *e) {
+    if (e->button() == Qt::LeftButton) {
+        m_dragging = false;
+        unsetCursor();
+    }
+}
+
+void RHIWidget::mouseDoubleClickEvent(QMouseEvent *) {
+    m_scale = 1.0;
+    m_offset = QPointF(0, 0);
+    update();
+}
+
+void RHIWidget::leaveEvent(QEvent *) {
+    if (m_hoverRay >= 0) {
+        m_hoverRay = -1;
+        emit rayHovered(-1);
+    }
+}
+
+void RHIWidget::wheelEvent(QWheelEvent *e) {
+    QRectF area = QRectF(rect()).adjusted(MarginLeft, MarginTop, -MarginRight, -MarginBottom);
+    QPointF pRel = e->position() - area.center();
+    double factor = (e->angleDelta().y() > 0) ? 1.15 : 0.85;
+    double oldS = m_scale;
+    m_scale = qBound(0.2, m_scale * factor, 50.0);
+    m_offset = pRel - (pRel - m_offset) * (m_scale / oldS);
+    m_settleTimer->start();
+    update();
+}
+
+void RHIWidget::mouseMoveEvent(QMouseEvent *e) {
+    if (m_dragging) {
+        QPoint delta = e->pos() - m_lastMousePos;
+        m_offset += QPointF(delta.x(), delta.y());
+        m_lastMousePos = e->pos();
+        update();
+        return;
+    }
+
+    int gate = -1;
+    int rayIdx = rayAtPosition(e->position(), &gate);
+    if (rayIdx != m_hoverRay) {
+        m_hoverRay = rayIdx;
+        emit rayHovered(rayIdx);
+    }
+    if (rayIdx >= 0 && gate >= 0) {
+        const RadarRay &ray = m_data->at(rayIdx);
+        const RangeGate &g = ray.gates[gate];
+        double el = qDegreesToRadians(ray.elevation);
+        QString info = QString("仰角: %1°\n斜距: %2 m\n高度: %3 m\n风速: %4 m/s\nSNR: %5\n湍流: %6")
+                           .arg(ray.elevation, 0, 'f', 1)
+                           .arg(g.distance, 0, 'f', 0)
+                           .arg(g.distance * std::sin(el), 0, 'f', 0)
+                           .arg(g.speed, 0, 'f', 2)
+                           .arg(g.snr, 0, 'f', 1)
+                           .arg(g.turbulence, 0, 'f', 3);
+        QToolTip::showText(e->globalPosition().toPoint(), info, this);
+    } else {
+        QToolTip::hideText();
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef RHIWIDGET_H
+#define RHIWIDGET_H
+
+#include <QWidget>
+#include <QImage>
+#include <QTimer>
+#include "datatypes.h"
+#include "colormap.h"
+
+class QComboBox;
+
+// 距离-高度显示 (RHI)：固定方位、扫仰角的扫描画成竖直剖面，横轴水平距离、纵轴高度。
+//  - 先把每条射线每个距离门的颜色查好（色标查找表），再逐像素反算 (仰角, 斜距) 取色
+//  - 栅格按世界坐标（米）缓存，平移/缩放只改贴图变换；放大到明显发虚时停手后再按新分辨率重画
+//  - 默认跟随回放：显示播放位置之前最近的一次 RHI 扫描；扫描逐帧变长时只重画新射线所在的扇区
+class RHIWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit RHIWidget(QWidget *parent = nullptr);
+
+    void setData(const ScanData* data, const SweepList* sweeps);
+    void setDisplayMode(DisplayMode mode);
+    void setColorMap(DisplayMode mode, const ColorMap& colors);
+    void setDistanceRange(double min, double max);
+    void setPlayLimit(int limit);
+    void refresh(); // 处理参数变化
+
+    bool hasRhi() const { return !m_rhi.isEmpty(); }
+    void setSweep(int rhiIndex); // -1 跟随回放
+
+signals:
+    void raySelected(int rayIndex);
+    void rayHovered(int rayIndex); // -1 表示移出
+    void availabilityChanged(bool hasRhi);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+    void leaveEvent(QEvent *event) override;
+
+private:
+    // 按世界坐标缓存的栅格及其生成参数
+    struct Raster {
+        QImage image;
+        QRectF world;          // 图像覆盖的范围 (米)：x 水平距离，y 高度（向上）
+        double pxPerM = 0.0;   // 生成时的分辨率
+        int sweep = -1, end = 0;
+        DisplayMode mode = Mode_Speed;
+        quint64 colorSerial = 0;
+        double minDist = 0.0, maxDist = 0.0;
+        quint64 revision = 0;
+    };
+    // 当前扫描按仰角排序的射线，拾取与栅格化共用
+    struct Beam {
+        double elevation;
+        int ray;
+    };
+
+    int currentSweep(int& end) const;
+    void prepareBeams(int sweep, int end);
+    int beamAt(double elevation) const;
+    QRectF worldBox() const;
+    double pxPerMeter() const;
+    QPointF worldOrigin() const;         // 世界原点 (雷达) 在屏幕上的位置
+    QPointF toScreen(double x, double y) const;
+    QPointF toWorld(const QPointF& pos) const;
+    void ensureRaster();
+    int rayAtPosition(const QPointF& pos, int* gate = nullptr) const;
+    void drawAxes(QPainter& p, const QRectF& box);
+    void rebuildSweepBox();
+
+    const ScanData* m_data = nullptr;
+    const SweepList* m_sweeps = nullptr;
+    QVector<int> m_rhi; // RHI 扫描在 m_sweeps 中的下标
+    DisplayMode m_mode = Mode_Speed;
+    ColorMap m_colors[2] = { ColorMap(Mode_Speed), ColorMap(Mode_Turbulence) };
+    double m_minDist = 0.0, m_maxDist = 10000.0;
+    int m_playLimit = -1;
+    int m_selected = -1; // -1 跟随回放
+    quint64 m_revision = 0;
+
+    QVector<Beam> m_beams;
+    int m_beamSweep = -1, m_beamEnd = -1;
+    quint64 m_beamRevision = ~0ull;
+    double m_halfWidth = 0.5; // 射线半宽 (度)
+    QVector<float> m_edges;   // 当前扫描的距离门边界
+
+    Raster m_raster;
+    double m_scale = 1.0;
+    QPointF m_offset;
+    QPoint m_lastMousePos;
+    bool m_dragging = false;
+    int m_hoverRay = -1;
+    QTimer* m_settleTimer; // 缩放停手后按需提高栅格分辨率
+    QComboBox* m_sweepBox;
+
+    static constexpr int MaxRasterSide = 4096;
+    static constexpr int MarginLeft = 60, MarginRight = 90, MarginTop = 34, MarginBottom = 36;
+};
+
+#endif // RHIWIDGET_H
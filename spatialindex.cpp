@@ -0,0 +1,113 @@
+#include "spatialindex.h"
+#include <algorithm>
+#include <cmath>
+
+void PPISpatialIndex::clear() {
+    m_sweeps.clear();
+    m_anyCoverage.clear();
+    m_uniform = false;
+    m_gateCount = 0;
+}
+
+int PPISpatialIndex::binOf(double azimuth) {
+    double a = std::fmod(azimuth, 360.0);
+    if (a < 0) a += 360.0;
+    return std::min(Bins - 1, int(a / BinWidth));
+}
+
+bool PPISpatialIndex::covers(double rayAzimuth, double azimuth) {
+    double d = std::fmod(azimuth - rayAzimuth, 360.0);
+    if (d < 0) d += 360.0;
+    return d < RayWidth;
+}
+
+void PPISpatialIndex::build(const ScanData &data, const SweepList &sweeps) {
+    clear();
+    if (data.isEmpty()) return;
+    m_anyCoverage.fill(false, Bins);
+
+    const int span = int(std::ceil(RayWidth / BinWidth));
+    for (const SweepInfo &s : sweeps) {
+        SweepBins sb{s.firstRay, s.rayCount, s.type == Scan_RHI, QVector<quint16>(Bins, NoRay)};
+        if (sb.rhi) {
+            m_sweeps << sb;
+            continue;
+        }
+        // 按绘制顺序写入，后画的射线覆盖先画的
+        for (int k = 0; k < s.rayCount && k < NoRay; ++k) {
+            double az = data[s.firstRay + k].azimuth;
+            int b0 = binOf(az);
+            for (int d = 0; d <= span; ++d) {
+                int b = (b0 + d) % Bins;
+                if (!covers(az, (b + 0.5) * BinWidth)) continue;
+                sb.bins[b] = quint16(k);
+                m_anyCoverage[b] = true;
+            }
+        }
+        m_sweeps << sb;
+    }
+
+    // 距离门几何：取第一条射线，检查是否等间距
+    const RadarRay &r0 = data.first();
+    m_gateCount = r0.gates.size();
+    if (m_gateCount >= 2) {
+        m_d0 = r0.gates.first().distance;
+        m_dr = (r0.gates.last().distance - m_d0) / (m_gateCount - 1);
+        m_uniform = m_dr > 0;
+        for (int j = 1; j < m_gateCount && m_uniform; ++j) {
+            double expect = m_d0 + j * m_dr;
+            if (std::abs(r0.gates[j].distance - expect) > 0.01 * m_dr) m_uniform = false;
+        }
+    }
+}
+
+int PPISpatialIndex::sweepOf(int rayIndex) const {
+    auto it = std::upper_bound(m_sweeps.begin(), m_sweeps.end(), rayIndex,
+                               [](int idx, const SweepBins &s) { return idx < s.firstRay; });
+    return int(it - m_sweeps.begin()) - 1;
+}
+
+// ---------------------------------------------------------
+// 从包含 end-1 的 sweep 往前找，都先查分箱表 O(1)。
+// 被窗口截断的 sweep（正在回放的那个、时间窗两端）：表里记的是整个 sweep 最后覆盖该方向的射线，
+// 落在 [lo, hi) 内就是答案，在 lo 之前说明窗口内没有射线覆盖；只有它被 end 截掉时才逐条往回找
+// ---------------------------------------------------------
+int PPISpatialIndex::rayAt(const ScanData &data, double azimuth, int begin, int end) const {
+    if (end <= begin || m_sweeps.isEmpty()) return -1;
+    int bin = binOf(azimuth);
+    if (!m_anyCoverage[bin]) return -1;
+
+    for (int si = sweepOf(end - 1); si >= 0; --si) {
+        const SweepBins &s = m_sweeps[si];
+        int sEnd = s.firstRay + s.rayCount;
+        if (sEnd <= begin) break;
+        if (s.rhi) continue;
+
+        quint16 off = s.bins[bin];
+        if (off == NoRay) continue;
+        int last = s.firstRay + off;
+        int lo = std::max(begin, s.firstRay);
+        int hi = std::min(end, sEnd);
+        if (last < lo) continue;
+        if (last < hi) return last;
+        for (int i = hi - 1; i >= lo; --i) {
+            if (covers(data[i].azimuth, azimuth)) return i;
+        }
+    }
+    return -1;
+}
+
+int PPISpatialIndex::gateAt(const RadarRay &ray, double distance) const {
+    int n = ray.gates.size();
+    if (n < 2) return -1;
+    int j;
+    if (m_uniform && n == m_gateCount) {
+        j = int(std::floor((distance - m_d0) / m_dr));
+    } else {
+        auto it = std::upper_bound(ray.gates.begin(), ray.gates.end(), distance,
+                                   [](double d, const RangeGate &g) { return d < g.distance; });
+        j = int(it - ray.gates.begin()) - 1;
+    }
+    // 最后一个门只作为上一个扇区的外边界，本身不绘制
+    return (j >= 0 && j < n - 1) ? j : -1;
+}
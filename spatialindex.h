@@ -0,0 +1,49 @@
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include "datatypes.h"
+
+// PPI 悬停/拾取用的空间索引：
+//  - 方位：每个 sweep 按 0.1° 分箱，记录覆盖该方向的最后一条射线（与绘制时的覆盖顺序一致）
+//  - 距离：距离门等间距时直接由距离算出门号，否则退化为二分查找
+class PPISpatialIndex
+{
+public:
+    static constexpr double BinWidth = 0.1;
+    static constexpr int Bins = 3600;
+    static constexpr double RayWidth = 1.2; // 每条射线绘制的扇区宽度 (度)，与 PPIWidget 一致
+
+    void clear();
+    void build(const ScanData& data, const SweepList& sweeps);
+    bool isEmpty() const { return m_sweeps.isEmpty(); }
+
+    // [begin, end) 范围内，方位 az 处最后绘制的射线；没有则返回 -1
+    int rayAt(const ScanData& data, double azimuth, int begin, int end) const;
+    // 距离 dist 落在哪个距离门扇区 [d_j, d_j+1)；不在范围内返回 -1
+    int gateAt(const RadarRay& ray, double distance) const;
+
+    static bool covers(double rayAzimuth, double azimuth);
+
+private:
+    static int binOf(double azimuth);
+    int sweepOf(int rayIndex) const;
+
+    struct SweepBins {
+        int firstRay;
+        int rayCount;
+        bool rhi;              // RHI 不画在 PPI 上，也不参与拾取
+        QVector<quint16> bins; // 相对 firstRay 的偏移，NoRay 表示该方向无射线
+    };
+    static constexpr quint16 NoRay = 0xFFFF;
+
+    QVector<SweepBins> m_sweeps;
+    QVector<bool> m_anyCoverage; // 全部数据中该方向是否有射线，用于快速排除空白扇区
+
+    // 距离门几何
+    bool m_uniform = false;
+    double m_d0 = 0.0;
+    double m_dr = 0.0;
+    int m_gateCount = 0;
+};
+
+#endif // SPATIALINDEX_H
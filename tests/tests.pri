@@ -0,0 +1,11 @@
+# 各测试工程共用的设置，被测源文件在仓库根目录
+QT += testlib
+QT -= gui
+CONFIG += testcase c++17 console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/..
+DEPENDPATH += $$PWD/..
+
+win32:DEFINES += _USE_MATH_DEFINES
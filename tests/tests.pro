@@ -0,0 +1,9 @@
+# 单元测试：不依赖界面，各自只编译被测的那几个源文件
+#   qmake tests/tests.pro && make && make check
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    tst_vadretrieval \
+    tst_gifencoder \
+    tst_framehistogram \
+    tst_pipeline
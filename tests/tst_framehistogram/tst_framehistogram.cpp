@@ -0,0 +1,60 @@
+#include <QtTest>
+#include "renderstats.h"
+
+class TestFrameTimeHistogram : public QObject
+{
+    Q_OBJECT
+private slots:
+    void empty();
+    void percentile();
+    void rollingWindow();
+    void histogram();
+};
+
+void TestFrameTimeHistogram::empty() {
+    FrameTimeHistogram h(8);
+    QCOMPARE(h.count(), 0);
+    QCOMPARE(h.mean(), 0.0);
+    QCOMPARE(h.percentile(0.5), 0.0);
+    QCOMPARE(h.histogram(1.0, 3), QVector<int>({ 0, 0, 0 }));
+}
+
+void TestFrameTimeHistogram::percentile() {
+    FrameTimeHistogram h(100);
+    // 乱序加入 1..11，分位数按最近秩取
+    for (int v : { 7, 3, 11, 1, 9, 5, 2, 10, 4, 8, 6 }) h.add(v);
+    QCOMPARE(h.count(), 11);
+    QCOMPARE(h.mean(), 6.0);
+    QCOMPARE(h.percentile(0.0), 1.0);
+    QCOMPARE(h.percentile(0.5), 6.0);
+    QCOMPARE(h.percentile(0.95), 11.0); // 0.95 * 10 = 9.5，四舍五入取下标 10
+    QCOMPARE(h.percentile(1.0), 11.0);
+    QCOMPARE(h.percentile(2.0), 11.0); // 越界按两端截断
+}
+
+// 满了以后覆盖最旧的样本，samples() 仍按从旧到新排列
+void TestFrameTimeHistogram::rollingWindow() {
+    FrameTimeHistogram h(4);
+    for (int i = 1; i <= 6; ++i) h.add(i);
+    QCOMPARE(h.count(), 4);
+    QCOMPARE(h.samples(), QVector<double>({ 3, 4, 5, 6 }));
+    QCOMPARE(h.mean(), 4.5);
+    QCOMPARE(h.percentile(0.0), 3.0);
+    QCOMPARE(h.percentile(0.5), 5.0);
+
+    h.clear();
+    QCOMPARE(h.count(), 0);
+    h.add(2.5);
+    QCOMPARE(h.samples(), QVector<double>({ 2.5 }));
+}
+
+void TestFrameTimeHistogram::histogram() {
+    FrameTimeHistogram h(16);
+    for (double ms : { 0.2, 0.9, 1.0, 1.5, 2.9, 3.0, 40.0, 250.0 }) h.add(ms);
+    // 1 ms 一桶共 4 桶，>=3 ms 的全部进最后一桶
+    QCOMPARE(h.histogram(1.0, 4), QVector<int>({ 2, 2, 1, 3 }));
+    QCOMPARE(h.histogram(2.0, 2), QVector<int>({ 4, 4 }));
+}
+
+QTEST_APPLESS_MAIN(TestFrameTimeHistogram)
+#include "tst_framehistogram.moc"
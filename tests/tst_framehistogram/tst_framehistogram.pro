@@ -0,0 +1,5 @@
+include(../tests.pri)
+
+TARGET = tst_framehistogram
+SOURCES += tst_framehistogram.cpp \
+    $$PWD/../../renderstats.cpp
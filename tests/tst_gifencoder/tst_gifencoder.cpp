@@ -0,0 +1,147 @@
+#include <QtTest>
+#include "gifencoder.h"
+
+// 从 GifEncoder::frame 的输出里取出图像数据并按 GIF 规范解 LZW（最小码长 8）。
+// 码宽按解码端的规则增长：每读一个码加一项字典，下一项编号到 2^codeSize 时加一位
+static bool decodeFrame(const QByteArray &frame, QRect &rect, QVector<uchar> &out) {
+    // 图形控制扩展 8 字节，随后是图像描述符
+    if (frame.size() < 20 || uchar(frame[8]) != 0x2C) return false;
+    auto u16 = [&frame](int i) { return uchar(frame[i]) | (uchar(frame[i + 1]) << 8); };
+    rect = QRect(u16(9), u16(11), u16(13), u16(15));
+    if (frame[18] != char(8)) return false;
+
+    QByteArray data;
+    int pos = 19;
+    while (pos < frame.size() && frame[pos] != 0) {
+        const int n = uchar(frame[pos]);
+        data.append(frame.constData() + pos + 1, n);
+        pos += n + 1;
+    }
+
+    const int clearCode = 256, eoiCode = 257;
+    QVector<int> prefix(4096, -1);
+    QVector<uchar> suffix(4096);
+    for (int i = 0; i < 256; ++i) suffix[i] = uchar(i);
+    auto expand = [&](int code) {
+        QVector<uchar> s;
+        for (; code >= 0; code = prefix[code]) s.prepend(suffix[code]);
+        return s;
+    };
+
+    qint64 bitPos = 0;
+    auto read = [&](int size) {
+        if (bitPos + size > qint64(data.size()) * 8) return -1;
+        int code = 0;
+        for (int b = 0; b < size; ++b, ++bitPos)
+            if (uchar(data[int(bitPos >> 3)]) >> (bitPos & 7) & 1) code |= 1 << b;
+        return code;
+    };
+
+    int codeSize = 9, next = eoiCode + 1, prev = -1;
+    out.clear();
+    for (;;) {
+        const int code = read(codeSize);
+        if (code < 0) return false; // 没读到 EOI 就没数据了
+        if (code == clearCode) {
+            codeSize = 9;
+            next = eoiCode + 1;
+            prev = -1;
+            continue;
+        }
+        if (code == eoiCode) return true;
+        if (prev < 0) {
+            if (code > 255) return false;
+            out << uchar(code);
+            prev = code;
+            continue;
+        }
+        QVector<uchar> s;
+        if (code < next) s = expand(code);
+        else if (code == next) { s = expand(prev); const uchar c = s.first(); s << c; }
+        else return false;
+        out << s;
+        if (next < 4096) {
+            prefix[next] = prev;
+            suffix[next] = s.first();
+            if (++next == (1 << codeSize) && codeSize < 12) ++codeSize;
+        }
+        prev = code;
+    }
+}
+
+// 固定种子的伪随机下标，symbols 越少重复串越多
+static QVector<uchar> pattern(int n, int symbols, quint32 seed) {
+    QVector<uchar> v(n);
+    for (int i = 0; i < n; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        v[i] = uchar((seed >> 16) % symbols);
+    }
+    return v;
+}
+
+class TestGifEncoder : public QObject
+{
+    Q_OBJECT
+private slots:
+    void roundTrip_data();
+    void roundTrip();
+    void everyTailLength();
+    void subRect();
+};
+
+void TestGifEncoder::roundTrip_data() {
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    QTest::addColumn<int>("symbols");
+    QTest::newRow("single pixel") << 1 << 1 << 256;
+    QTest::newRow("flat") << 64 << 64 << 1;
+    QTest::newRow("few colors") << 200 << 150 << 4;
+    QTest::newRow("noise, dictionary resets") << 300 << 300 << 256;
+}
+
+void TestGifEncoder::roundTrip() {
+    QFETCH(int, width);
+    QFETCH(int, height);
+    QFETCH(int, symbols);
+    QVector<uchar> img = pattern(width * height, symbols, 7);
+    QByteArray frame = GifEncoder::frame(img.constData(), width, QRect(0, 0, width, height), 5);
+
+    QRect rect;
+    QVector<uchar> decoded;
+    QVERIFY(decodeFrame(frame, rect, decoded));
+    QCOMPARE(rect, QRect(0, 0, width, height));
+    QCOMPARE(decoded, img);
+}
+
+// 帧末尾正好碰上码宽增长（字典到 511/1023/2047 项）时 EOI 的码宽最容易写错：
+// 逐个长度试一遍，覆盖 9→10、10→11、11→12 的所有边界
+void TestGifEncoder::everyTailLength() {
+    for (int n = 1; n <= 4200; ++n) {
+        QVector<uchar> img = pattern(n, 256, quint32(n));
+        QByteArray frame = GifEncoder::frame(img.constData(), n, QRect(0, 0, n, 1), 5);
+        QRect rect;
+        QVector<uchar> decoded;
+        if (!decodeFrame(frame, rect, decoded) || decoded != img)
+            QFAIL(qPrintable(QString("round trip failed for %1 pixels").arg(n)));
+    }
+}
+
+// 只编码变化区域的外接矩形，行宽仍是整帧的
+void TestGifEncoder::subRect() {
+    const int w = 120, h = 80;
+    QVector<uchar> img = pattern(w * h, 16, 3);
+    const QRect r(17, 9, 50, 33);
+    QByteArray frame = GifEncoder::frame(img.constData(), w, r, 5);
+
+    QRect rect;
+    QVector<uchar> decoded;
+    QVERIFY(decodeFrame(frame, rect, decoded));
+    QCOMPARE(rect, r);
+    QVector<uchar> expected;
+    for (int y = r.top(); y <= r.bottom(); ++y)
+        for (int x = r.left(); x <= r.right(); ++x) expected << img[y * w + x];
+    QCOMPARE(decoded, expected);
+}
+
+QTEST_APPLESS_MAIN(TestGifEncoder)
+#include "tst_gifencoder.moc"
@@ -0,0 +1,6 @@
+include(../tests.pri)
+QT += gui
+
+TARGET = tst_gifencoder
+SOURCES += tst_gifencoder.cpp \
+    $$PWD/../../gifencoder.cpp
@@ -0,0 +1,136 @@
+#include <QtTest>
+#include <cmath>
+#include "processingpipeline.h"
+
+static ScanData sampleData() {
+    ScanData data;
+    const QDateTime t0 = QDateTime::fromMSecsSinceEpoch(1700000000000LL);
+    for (int i = 0; i < 6; ++i) {
+        RadarRay ray;
+        ray.timestamp = t0.addMSecs(i * 100);
+        ray.azimuth = i * 60.0;
+        ray.elevation = 5.0;
+        for (int j = 0; j < 24; ++j) {
+            float speed = float(3.0 * std::sin(0.3 * j + i));
+            if (j == 10) speed += 8.0f; // 一个野值
+            ray.gates.append({ float(100 + 30 * j), speed, float(-25 + 2 * j), 0.0f, true });
+        }
+        data << ray;
+    }
+    return data;
+}
+
+static QVector<bool> validity(const ScanData &data) {
+    QVector<bool> v;
+    for (const auto &r : data)
+        for (const auto &g : r.gates) v << g.isValid;
+    return v;
+}
+
+static QVector<float> turbulence(const ScanData &data) {
+    QVector<float> v;
+    for (const auto &r : data)
+        for (const auto &g : r.gates) v << g.turbulence;
+    return v;
+}
+
+class TestProcessingPipeline : public QObject
+{
+    Q_OBJECT
+private slots:
+    void stageKeyInvalidation();
+    void newSourceInvalidates();
+};
+
+// 每个阶段的键只含它自己和上游的参数：改下游不重算上游，参数回退直接命中
+void TestProcessingPipeline::stageKeyInvalidation() {
+    ProcessingPipeline pipe;
+    pipe.setSource(sampleData());
+    auto computed = [&pipe]() {
+        return QVector<int>({ pipe.computeCount(ProcessingPipeline::Stage_Filter),
+                              pipe.computeCount(ProcessingPipeline::Stage_Outlier),
+                              pipe.computeCount(ProcessingPipeline::Stage_Turbulence) });
+    };
+    auto hits = [&pipe]() {
+        return QVector<int>({ pipe.hitCount(ProcessingPipeline::Stage_Filter),
+                              pipe.hitCount(ProcessingPipeline::Stage_Outlier),
+                              pipe.hitCount(ProcessingPipeline::Stage_Turbulence) });
+    };
+
+    PipelineParams p0;
+    ScanData first = pipe.run(p0);
+    QCOMPARE(computed(), QVector<int>({ 1, 1, 1 }));
+    QCOMPARE(hits(), QVector<int>({ 0, 0, 0 }));
+
+    // 参数不变：最后一阶段直接命中
+    pipe.run(p0);
+    QCOMPARE(computed(), QVector<int>({ 1, 1, 1 }));
+    QCOMPARE(hits(), QVector<int>({ 0, 0, 1 }));
+
+    // 只改湍流窗口：从野值阶段的缓存接着算
+    PipelineParams p1 = p0;
+    p1.windowSize = 7;
+    ScanData wide = pipe.run(p1);
+    QCOMPARE(computed(), QVector<int>({ 1, 1, 2 }));
+    QCOMPARE(hits(), QVector<int>({ 0, 1, 1 }));
+    QVERIFY(turbulence(wide) != turbulence(first));
+
+    // 野值阈值 <=0 都表示关闭，键相同
+    PipelineParams p2 = p1;
+    p2.outlierThreshold = -1.0;
+    pipe.run(p2);
+    QCOMPARE(computed(), QVector<int>({ 1, 1, 2 }));
+    QCOMPARE(hits(), QVector<int>({ 0, 1, 2 }));
+
+    // 打开野值修复：过滤阶段命中，其后两段重算
+    PipelineParams p3 = p1;
+    p3.outlierThreshold = 2.0;
+    pipe.run(p3);
+    QCOMPARE(computed(), QVector<int>({ 1, 2, 3 }));
+    QCOMPARE(hits(), QVector<int>({ 1, 1, 2 }));
+
+    // 改最上游的 SNR 阈值：全部重算，过滤结果按新阈值
+    PipelineParams p4 = p3;
+    p4.snrThreshold = 0.0;
+    ScanData strict = pipe.run(p4);
+    QCOMPARE(computed(), QVector<int>({ 2, 3, 4 }));
+    QCOMPARE(hits(), QVector<int>({ 1, 1, 2 }));
+    for (const auto &r : strict)
+        for (const auto &g : r.gates) QCOMPARE(g.isValid, g.snr >= 0.0f);
+
+    // 回到最初的参数：还在缓存里，结果与第一次一致
+    ScanData again = pipe.run(p0);
+    QCOMPARE(computed(), QVector<int>({ 2, 3, 4 }));
+    QCOMPARE(hits(), QVector<int>({ 1, 1, 3 }));
+    QCOMPARE(validity(again), validity(first));
+    QCOMPARE(turbulence(again), turbulence(first));
+}
+
+// 换数据源版本号加一，旧结果不再命中
+void TestProcessingPipeline::newSourceInvalidates() {
+    ProcessingPipeline pipe;
+    const ScanData data = sampleData();
+    pipe.setSource(data);
+    const quint64 v0 = pipe.sourceVersion();
+    PipelineParams p;
+    pipe.run(p);
+    QCOMPARE(pipe.computeCount(ProcessingPipeline::Stage_Filter), 1);
+
+    pipe.setSource(data);
+    QVERIFY(pipe.sourceVersion() != v0);
+    pipe.run(p);
+    QCOMPARE(pipe.computeCount(ProcessingPipeline::Stage_Filter), 2);
+    QCOMPARE(pipe.hitCount(ProcessingPipeline::Stage_Turbulence), 0);
+
+    pipe.setSource(CompactScanData::fromScan(data));
+    QVERIFY(pipe.isCompactSource());
+    ScanData out = pipe.run(p);
+    QCOMPARE(pipe.computeCount(ProcessingPipeline::Stage_Filter), 3);
+    QCOMPARE(out.size(), data.size());
+    ScanData cached = pipe.run(p);
+    QCOMPARE(pipe.hitCount(ProcessingPipeline::Stage_Turbulence), 1);
+    QCOMPARE(validity(cached), validity(out));
+}
+
+QTEST_APPLESS_MAIN(TestProcessingPipeline)
+#include "tst_pipeline.moc"
@@ -0,0 +1,6 @@
+include(../tests.pri)
+
+TARGET = tst_pipeline
+SOURCES += tst_pipeline.cpp \
+    $$PWD/../../processingpipeline.cpp \
+    $$PWD/../../compactscan.cpp
@@ -0,0 +1,86 @@
+#include <QtTest>
+#include <QtMath>
+#include <cmath>
+#include "vadretrieval.h"
+
+// 按给定的 u/v/w 合成一个 sweep：Vr = w·sin(el) + cos(el)·(u·sin(az) + v·cos(az))
+static ScanData syntheticSweep(double u, double v, double w, double elevation,
+                               double azFrom, double azTo, int rays, int gates) {
+    ScanData data;
+    const QDateTime t0 = QDateTime::fromMSecsSinceEpoch(1700000000000LL);
+    const double el = qDegreesToRadians(elevation);
+    for (int i = 0; i < rays; ++i) {
+        RadarRay ray;
+        ray.timestamp = t0.addMSecs(i * 100);
+        ray.azimuth = azFrom + (azTo - azFrom) * i / rays;
+        ray.elevation = elevation;
+        const double az = qDegreesToRadians(ray.azimuth);
+        const float vr = float(w * std::sin(el) + std::cos(el) * (u * std::sin(az) + v * std::cos(az)));
+        for (int j = 0; j < gates; ++j)
+            ray.gates.append({ float(100.0 + 30.0 * j), vr, 10.0f, 0.0f, true });
+        data << ray;
+    }
+    return data;
+}
+
+class TestVadRetrieval : public QObject
+{
+    Q_OBJECT
+private slots:
+    void fitKnownWind();
+    void rejectNarrowCoverage();
+    void retrieveReusesCache();
+};
+
+void TestVadRetrieval::fitKnownWind() {
+    const double u = 3.0, v = -4.0, w = 0.5;
+    ScanData data = syntheticSweep(u, v, w, 60.0, 0.0, 360.0, 72, 10);
+    SweepInfo sweep{ 0, int(data.size()), 60.0 };
+
+    WindProfile p = VadRetrieval::fitSweep(data, sweep, VadParams());
+    QCOMPARE(p.valid.size(), 10);
+    // 来向 atan2(-u, -v) = -36.87°，即约 323°（西北风）
+    const double dir = qRadiansToDegrees(std::atan2(-u, -v)) + 360.0;
+    for (int j = 0; j < p.valid.size(); ++j) {
+        QVERIFY(p.valid[j]);
+        QVERIFY(qAbs(p.speed[j] - 5.0) < 1e-3);
+        QVERIFY(qAbs(p.direction[j] - dir) < 1e-2);
+        QVERIFY(qAbs(p.vertical[j] - w) < 1e-3);
+        QVERIFY(p.residual[j] < 1e-3);
+        QVERIFY(qAbs(p.height[j] - p.distance[j] * std::sin(qDegreesToRadians(60.0))) < 1e-6);
+    }
+}
+
+void TestVadRetrieval::rejectNarrowCoverage() {
+    // 只扫了 90° 扇区，低于默认的 180° 覆盖下限
+    ScanData data = syntheticSweep(3.0, -4.0, 0.0, 10.0, 0.0, 90.0, 30, 4);
+    SweepInfo sweep{ 0, int(data.size()), 10.0 };
+    WindProfile p = VadRetrieval::fitSweep(data, sweep, VadParams());
+    QCOMPARE(p.valid.size(), 4);
+    for (bool ok : p.valid) QVERIFY(!ok);
+}
+
+void TestVadRetrieval::retrieveReusesCache() {
+    ScanData a = syntheticSweep(1.0, 2.0, 0.0, 30.0, 0.0, 360.0, 36, 3);
+    ScanData b = syntheticSweep(-2.0, 0.5, 0.0, 30.0, 0.0, 360.0, 36, 3);
+    ScanData data = a + b;
+    SweepList sweeps;
+    sweeps << SweepInfo{ 0, int(a.size()), 30.0 } << SweepInfo{ int(a.size()), int(b.size()), 30.0 };
+
+    VadRetrieval vad;
+    QVector<WindProfile> first = vad.retrieve(data, sweeps);
+    QCOMPARE(first.size(), 2);
+    QCOMPARE(first[0].sweepIndex, 0);
+    QCOMPARE(first[1].sweepIndex, 1);
+    QVERIFY(qAbs(first[0].speed[0] - std::hypot(1.0, 2.0)) < 1e-3);
+    QVERIFY(qAbs(first[1].speed[0] - std::hypot(-2.0, 0.5)) < 1e-3);
+
+    // 数据没通知失效时沿用缓存，invalidate 之后按新数据重算
+    for (auto &g : data[0].gates) g.speed = 0.0f;
+    QCOMPARE(vad.retrieve(data, sweeps)[0].speed, first[0].speed);
+    vad.invalidate();
+    QVERIFY(vad.retrieve(data, sweeps)[0].speed != first[0].speed);
+}
+
+QTEST_APPLESS_MAIN(TestVadRetrieval)
+#include "tst_vadretrieval.moc"
@@ -0,0 +1,6 @@
+include(../tests.pri)
+QT += concurrent
+
+TARGET = tst_vadretrieval
+SOURCES += tst_vadretrieval.cpp \
+    $$PWD/../../vadretrieval.cpp
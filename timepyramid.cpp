@@ -0,0 +1,261 @@
+#include "timepyramid.h"
+#include <QtConcurrent>
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <cmath>
+
+// 版本号全局递增：后台建好的金字塔整体换上时，版本号一定和旧的不同
+static std::atomic<quint64> s_revision{0};
+
+static int azimuthBin(double az) {
+    double a = std::fmod(az, 360.0);
+    if (a < 0) a += 360.0;
+    return std::min(TimePyramid::AzimuthBins - 1, int(a * TimePyramid::AzimuthBins / 360.0));
+}
+
+static qint16 quantize(double v, float scale) {
+    return qint16(std::clamp(std::lround(v / scale), -32767L, 32767L));
+}
+
+// ---------------------------------------------------------
+// 累加器
+// ---------------------------------------------------------
+void PyramidAccumulator::reset(int gates) {
+    m_gates = gates;
+    m_binSlot.fill(-1, TimePyramid::AzimuthBins);
+    m_cells.clear();
+}
+
+int PyramidAccumulator::slotFor(int bin) {
+    int slot = m_binSlot[bin];
+    if (slot < 0) {
+        slot = int(m_cells.size()) / std::max(1, m_gates);
+        m_binSlot[bin] = slot;
+        m_cells.resize(m_cells.size() + m_gates);
+    }
+    return slot;
+}
+
+int PyramidAccumulator::addRay(const RadarRay &ray) {
+    int slot = slotFor(azimuthBin(ray.azimuth));
+    Cell *cells = m_cells.data() + slot * m_gates;
+    int n = std::min(m_gates, int(ray.gates.size()));
+    for (int j = 0; j < n; ++j) {
+        const RangeGate &g = ray.gates[j];
+        if (!g.isValid) continue;
+        Cell &c = cells[j];
+        c.speedSum += g.speed;
+        c.speedMax = std::max(c.speedMax, g.speed);
+        c.turbSum += g.turbulence;
+        c.turbMax = std::max(c.turbMax, g.turbulence);
+        c.snrSum += g.snr;
+        c.count++;
+    }
+    return slot;
+}
+
+void PyramidAccumulator::addBucket(const PyramidBucket &b) {
+    for (int bin = 0; bin < TimePyramid::AzimuthBins; ++bin) {
+        int src = b.binSlot[bin];
+        if (src < 0) continue;
+        const PyramidCell *in = b.cells.constData() + src * m_gates;
+        Cell *cells = m_cells.data() + slotFor(bin) * m_gates;
+        for (int j = 0; j < m_gates; ++j) {
+            const PyramidCell &p = in[j];
+            if (p.count == 0) continue;
+            Cell &c = cells[j];
+            c.speedSum += double(p.meanSpeed()) * p.count;
+            c.speedMax = std::max(c.speedMax, p.maxSpeed());
+            c.turbSum += double(p.meanTurb()) * p.count;
+            c.turbMax = std::max(c.turbMax, p.maxTurb());
+            c.snrSum += double(p.meanSnr()) * p.count;
+            c.count += p.count;
+        }
+    }
+}
+
+void PyramidAccumulator::quantizeSlot(PyramidCell *out, int slot) const {
+    const Cell *in = slotCells(slot);
+    out += slot * m_gates;
+    for (int j = 0; j < m_gates; ++j) {
+        const Cell &c = in[j];
+        PyramidCell &p = out[j];
+        if (c.count == 0) { p = PyramidCell{0, 0, 0, 0, 0, 0}; continue; }
+        p.speedMean = quantize(c.speedSum / c.count, PyramidCell::SpeedScale);
+        p.speedMax = quantize(c.speedMax, PyramidCell::SpeedScale);
+        p.turbMean = quantize(c.turbSum / c.count, PyramidCell::TurbScale);
+        p.turbMax = quantize(c.turbMax, PyramidCell::TurbScale);
+        p.snrMean = quantize(c.snrSum / c.count, PyramidCell::SnrScale);
+        p.count = quint16(std::min<quint32>(c.count, 65535));
+    }
+}
+
+void PyramidAccumulator::finish(PyramidBucket &b) const {
+    b.binSlot = m_binSlot;
+    b.cells.resize(m_cells.size());
+    const int slots = m_gates > 0 ? int(m_cells.size()) / m_gates : 0;
+    for (int s = 0; s < slots; ++s) quantizeSlot(b.cells.data(), s);
+}
+
+// ---------------------------------------------------------
+// 金字塔
+// ---------------------------------------------------------
+TimePyramid::TimePyramid() {
+    m_bucketSecs << 600 << 3600 << 6 * 3600 << 24 * 3600;
+    m_levels.resize(m_bucketSecs.size());
+}
+
+void TimePyramid::bumpRevision() {
+    m_revision = ++s_revision;
+}
+
+void TimePyramid::clear() {
+    for (auto &l : m_levels) l.clear();
+    m_distances.clear();
+    bumpRevision();
+}
+
+// 第 1 层先按时间切桶，再各桶并行累加原始射线；
+// 第 2 层起每个粗桶由它覆盖的细桶合并，同样按桶并行
+void TimePyramid::build(const ScanData &data, const QVector<bool> &mask) {
+    clear();
+    const bool masked = mask.size() == data.size();
+    auto included = [&mask, masked](int i) { return !masked || mask[i]; };
+    int firstIncluded = 0;
+    while (firstIncluded < data.size() && !included(firstIncluded)) firstIncluded++;
+    if (firstIncluded == data.size()) return;
+    for (const auto &g : data[firstIncluded].gates) m_distances << g.distance;
+    const int gates = m_distances.size();
+
+    QVector<PyramidBucket> &first = m_levels[0];
+    QVector<int> rayEnd; // 每个桶覆盖的原始射线下标上界（中间夹着被排除的射线）
+    const qint64 firstMs = m_bucketSecs[0] * 1000;
+    for (int i = firstIncluded; i < data.size(); ++i) {
+        if (!included(i)) continue;
+        qint64 t = data[i].timestamp.toMSecsSinceEpoch();
+        if (first.isEmpty() || t >= first.last().t0Ms + firstMs) {
+            PyramidBucket b;
+            b.t0Ms = (t / firstMs) * firstMs;
+            b.firstRay = i;
+            first << b;
+            rayEnd << i;
+        }
+        first.last().rayCount++;
+        rayEnd.last() = i + 1;
+    }
+    QVector<int> order(first.size());
+    std::iota(order.begin(), order.end(), 0);
+    PyramidBucket *buckets = first.data();
+    QtConcurrent::blockingMap(order, [&data, &rayEnd, &included, buckets, gates](int k) {
+        PyramidAccumulator acc(gates);
+        for (int i = buckets[k].firstRay; i < rayEnd[k]; ++i)
+            if (included(i)) acc.addRay(data[i]);
+        acc.finish(buckets[k]);
+    });
+
+    for (int l = 1; l < m_levels.size(); ++l) {
+        const QVector<PyramidBucket> &fine = m_levels[l - 1];
+        QVector<PyramidBucket> &coarse = m_levels[l];
+        const qint64 durMs = m_bucketSecs[l] * 1000;
+        QVector<int> fineBegin; // 每个粗桶的第一个细桶
+        for (int k = 0; k < fine.size(); ++k) {
+            const PyramidBucket &f = fine[k];
+            if (coarse.isEmpty() || f.t0Ms >= coarse.last().t0Ms + durMs) {
+                PyramidBucket b;
+                b.t0Ms = (f.t0Ms / durMs) * durMs;
+                b.firstRay = f.firstRay;
+                coarse << b;
+                fineBegin << k;
+            }
+            coarse.last().rayCount += f.rayCount;
+        }
+        fineBegin << fine.size();
+
+        QVector<int> order(coarse.size());
+        std::iota(order.begin(), order.end(), 0);
+        PyramidBucket *out = coarse.data();
+        QtConcurrent::blockingMap(order, [&fine, &fineBegin, out, gates](int c) {
+            PyramidAccumulator acc(gates);
+            for (int k = fineBegin[c]; k < fineBegin[c + 1]; ++k) acc.addBucket(fine[k]);
+            acc.finish(out[c]);
+        });
+    }
+    bumpRevision();
+}
+
+qint64 TimePyramid::memoryBytes() const {
+    qint64 bytes = 0;
+    for (const auto &level : m_levels) {
+        for (const PyramidBucket &b : level)
+            bytes += sizeof(PyramidBucket) + b.binSlot.size() * sizeof(int) + b.cells.size() * sizeof(PyramidCell);
+    }
+    return bytes;
+}
+
+int TimePyramid::bucketCount(int level, qint64 t0Ms, qint64 t1Ms) const {
+    if (level <= 0 || level > m_levels.size()) return 0;
+    const QVector<PyramidBucket> &bs = m_levels[level - 1];
+    qint64 durMs = m_bucketSecs[level - 1] * 1000;
+    auto first = std::lower_bound(bs.begin(), bs.end(), t0Ms,
+                                  [durMs](const PyramidBucket &b, qint64 t) { return b.t0Ms + durMs <= t; });
+    auto last = std::lower_bound(first, bs.end(), t1Ms,
+                                 [](const PyramidBucket &b, qint64 t) { return b.t0Ms < t; });
+    return int(last - first);
+}
+
+int TimePyramid::chooseLevel(qint64 t0Ms, qint64 t1Ms, int maxBuckets) const {
+    for (int l = 1; l <= m_levels.size(); ++l) {
+        if (bucketCount(l, t0Ms, t1Ms) <= maxBuckets) return l;
+    }
+    return m_levels.size();
+}
+
+// ---------------------------------------------------------
+// 合并窗口内的桶：每个方位分箱输出一条射线，门值取所选统计量
+// ---------------------------------------------------------
+ScanData TimePyramid::overview(int level, qint64 t0Ms, qint64 t1Ms, Statistic stat) const {
+    ScanData out;
+    if (level <= 0 || level > m_levels.size() || m_distances.isEmpty()) return out;
+
+    const QVector<PyramidBucket> &bs = m_levels[level - 1];
+    qint64 durMs = m_bucketSecs[level - 1] * 1000;
+    auto first = std::lower_bound(bs.begin(), bs.end(), t0Ms,
+                                  [durMs](const PyramidBucket &b, qint64 t) { return b.t0Ms + durMs <= t; });
+
+    const int gates = m_distances.size();
+    PyramidAccumulator merged(gates);
+    QVector<qint64> binTime(AzimuthBins, -1);
+    for (auto it = first; it != bs.end() && it->t0Ms < t1Ms; ++it) {
+        for (int bin = 0; bin < AzimuthBins; ++bin)
+            if (it->binSlot[bin] >= 0) binTime[bin] = it->t0Ms;
+        merged.addBucket(*it);
+    }
+
+    for (int bin = 0; bin < AzimuthBins; ++bin) {
+        if (binTime[bin] < 0) continue;
+        RadarRay ray;
+        ray.timestamp = QDateTime::fromMSecsSinceEpoch(binTime[bin]);
+        ray.azimuth = bin * 360.0 / AzimuthBins;
+        ray.elevation = 0.0;
+        ray.gates.resize(gates);
+        const PyramidAccumulator::Cell *c = merged.slotCells(merged.slotOf(bin));
+        for (int j = 0; j < gates; ++j) {
+            RangeGate &g = ray.gates[j];
+            g.distance = m_distances[j];
+            g.isValid = c[j].count > 0;
+            if (!g.isValid) { g.speed = g.snr = g.turbulence = 0.0f; continue; }
+            double n = c[j].count;
+            g.snr = float(c[j].snrSum / n);
+            if (stat == Stat_Max) {
+                g.speed = c[j].speedMax;
+                g.turbulence = c[j].turbMax;
+            } else {
+                g.speed = float(c[j].speedSum / n);
+                g.turbulence = float(c[j].turbSum / n);
+            }
+        }
+        out << ray;
+    }
+    return out;
+}
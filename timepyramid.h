@@ -0,0 +1,111 @@
+#ifndef TIMEPYRAMID_H
+#define TIMEPYRAMID_H
+
+#include "datatypes.h"
+#include <limits>
+
+// 金字塔单元：某时间桶内、某方位分箱、某距离门上的统计量。
+// 均值/最大值用 int16 定点存（12 字节，原来 float 版是 32 字节），计数到 65535 封顶
+struct PyramidCell {
+    static constexpr float SpeedScale = 0.01f; // m/s / LSB，与紧凑原始数据一致
+    static constexpr float TurbScale = 0.001f; // 湍流强度 / LSB，上限约 32
+    static constexpr float SnrScale = 0.01f;   // dB / LSB
+
+    qint16 speedMean, speedMax;
+    qint16 turbMean, turbMax;
+    qint16 snrMean;
+    quint16 count; // 有效样本数
+
+    float meanSpeed() const { return speedMean * SpeedScale; }
+    float maxSpeed() const { return speedMax * SpeedScale; }
+    float meanTurb() const { return turbMean * TurbScale; }
+    float maxTurb() const { return turbMax * TurbScale; }
+    float meanSnr() const { return snrMean * SnrScale; }
+};
+
+// 一个时间桶：按 1° 方位分箱聚合桶内全部射线
+struct PyramidBucket {
+    qint64 t0Ms = 0;            // 桶起始时间
+    int firstRay = 0;           // 桶内第一条原始射线
+    int rayCount = 0;
+    QVector<int> binSlot;       // 方位分箱 -> cells 中的槽位，-1 表示该方向无数据
+    QVector<PyramidCell> cells; // 槽位 * 门数 + 门号
+};
+
+// 一个桶的宽精度累加器：累加原始射线或合并细层的桶，最后量化成 PyramidBucket
+class PyramidAccumulator
+{
+public:
+    struct Cell {
+        double speedSum = 0.0, turbSum = 0.0, snrSum = 0.0;
+        float speedMax = -std::numeric_limits<float>::max();
+        float turbMax = -std::numeric_limits<float>::max();
+        quint32 count = 0;
+    };
+
+    explicit PyramidAccumulator(int gates = 0) { reset(gates); }
+
+    void reset(int gates);
+    int addRay(const RadarRay& ray);        // 返回射线落入的槽位
+    void addBucket(const PyramidBucket& b); // 合并一个细层桶（或从定点值恢复）
+
+    int slotOf(int bin) const { return m_binSlot[bin]; }
+    const Cell* slotCells(int slot) const { return m_cells.constData() + slot * m_gates; }
+
+    void finish(PyramidBucket& b) const; // 全部槽位量化到 b
+
+private:
+    int slotFor(int bin);
+    void quantizeSlot(PyramidCell* out, int slot) const;
+
+    int m_gates = 0;
+    QVector<int> m_binSlot;
+    QVector<Cell> m_cells;
+};
+
+// 时间多分辨率金字塔：第 0 层是原始射线本身（不复制），
+// 第 1..N 层按 10 分钟 / 1 小时 / 6 小时 / 1 天分桶，每桶保存 mean/max。
+// build 在调用线程里并行累加第 1 层，粗层由细层的桶合并而来，不再逐条扫射线。
+// 数据只在加载/改处理参数时整体变化，没有逐条到达的射线，所以只有整体重建：
+// 界面上放到后台线程，建好后整体换上（版本号全局唯一，换上即失效旧缓存）
+class TimePyramid
+{
+public:
+    enum Statistic {
+        Stat_Mean,
+        Stat_Max
+    };
+
+    static constexpr int AzimuthBins = 360;
+
+    TimePyramid();
+
+    void clear();
+    // 全量重建；mask 非空时只收为 true 的射线（混合扫描时排除 RHI，概览只画 PPI）
+    void build(const ScanData& data, const QVector<bool>& mask = QVector<bool>());
+
+    bool isEmpty() const { return m_levels.first().isEmpty(); }
+    int levelCount() const { return m_levels.size() + 1; } // 含第 0 层
+    qint64 bucketSeconds(int level) const { return level <= 0 ? 0 : m_bucketSecs[level - 1]; }
+    const QVector<PyramidBucket>& buckets(int level) const { return m_levels[level - 1]; }
+    quint64 revision() const { return m_revision; }
+    qint64 memoryBytes() const;
+
+    // 窗口 [t0, t1) 内第 level 层的桶数
+    int bucketCount(int level, qint64 t0Ms, qint64 t1Ms) const;
+    // 选取桶数不超过 maxBuckets 的最精细层（至少返回第 1 层）
+    int chooseLevel(qint64 t0Ms, qint64 t1Ms, int maxBuckets) const;
+
+    // 合并窗口内第 level 层的桶，每个方位分箱生成一条概览射线
+    ScanData overview(int level, qint64 t0Ms, qint64 t1Ms, Statistic stat = Stat_Mean) const;
+
+private:
+    void bumpRevision();
+
+    QVector<qint64> m_bucketSecs;
+    QVector<QVector<PyramidBucket>> m_levels;
+    QVector<float> m_distances; // 距离门（取第一条射线）
+    quint64 m_revision = 0;
+};
+
+#endif // TIMEPYRAMID_H
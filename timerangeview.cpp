@@ -0,0 +1,291 @@
+#include "timerangeview.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QComboBox>
+#include <QLabel>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+TimeRangeView::TimeRangeView(QWidget *parent) : QWidget(parent) {
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(2);
+
+    QHBoxLayout *bar = new QHBoxLayout;
+    bar->setContentsMargins(6, 2, 6, 0);
+    m_fieldBox = new QComboBox;
+    m_fieldBox->addItems({ "径向风速", "SNR", "湍流强度" });
+    m_aggBox = new QComboBox;
+    m_aggBox->addItems({ "均值", "最大值" });
+    bar->addWidget(new QLabel("时间-距离:"));
+    bar->addWidget(m_fieldBox);
+    bar->addWidget(m_aggBox);
+    bar->addStretch();
+    layout->addLayout(bar);
+
+    m_plot = new QCustomPlot;
+    m_plot->setBackground(QBrush(Qt::white));
+    m_plot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+    m_plot->axisRect()->setRangeDrag(Qt::Horizontal);
+    m_plot->axisRect()->setRangeZoom(Qt::Horizontal);
+    QSharedPointer<QCPAxisTickerDateTime> ticker(new QCPAxisTickerDateTime);
+    ticker->setDateTimeFormat("MM-dd\nHH:mm:ss");
+    m_plot->xAxis->setTicker(ticker);
+    m_plot->yAxis->setLabel("距离 (m)");
+
+    m_map = new QCPColorMap(m_plot->xAxis, m_plot->yAxis);
+    m_map->setInterpolate(false);
+    m_map->setTightBoundary(true);
+    m_colorScale = new QCPColorScale(m_plot);
+    m_plot->plotLayout()->addElement(0, 1, m_colorScale);
+    m_colorScale->setBarWidth(12);
+    m_map->setColorScale(m_colorScale);
+    QCPMarginGroup *group = new QCPMarginGroup(m_plot);
+    m_plot->axisRect()->setMarginGroup(QCP::msBottom | QCP::msTop, group);
+    m_colorScale->setMarginGroup(QCP::msBottom | QCP::msTop, group);
+    layout->addWidget(m_plot, 1);
+
+    // 拖动/滚轮时 rangeChanged 很密，合并到下一轮事件循环统一补列
+    m_updateTimer = new QTimer(this);
+    m_updateTimer->setSingleShot(true);
+    m_updateTimer->setInterval(0);
+    connect(m_updateTimer, &QTimer::timeout, this, &TimeRangeView::updateColumns);
+    connect(m_plot->xAxis, QOverload<const QCPRange &>::of(&QCPAxis::rangeChanged), this, [this]() { scheduleUpdate(); });
+    connect(m_fieldBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &TimeRangeView::setField);
+    connect(m_aggBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &TimeRangeView::setAggregate);
+
+    applyGradient();
+}
+
+void TimeRangeView::setData(const ScanData *data, const TimePyramid *pyramid) {
+    m_data = data;
+    m_pyramid = pyramid;
+    m_times.clear();
+    m_distances.clear();
+    m_columns.clear();
+    m_colMs = 0;
+    if (!m_data || m_data->isEmpty()) {
+        m_map->data()->clear();
+        m_plot->replot();
+        return;
+    }
+    for (const auto &g : m_data->first().gates) m_distances << g.distance;
+    appendData();
+    m_plot->xAxis->setRange(m_times.first() / 1000.0, m_times.last() / 1000.0 + 1.0);
+    if (m_distances.size() > 1) m_plot->yAxis->setRange(m_distances.first(), m_distances.last());
+    scheduleUpdate();
+}
+
+void TimeRangeView::appendData() {
+    if (!m_data) return;
+    const int from = m_times.size();
+    if (m_data->size() <= from) return;
+
+    const QCPRange x = m_plot->xAxis->range();
+    const bool following = from > 0 && x.upper >= m_times.last() / 1000.0; // 视图停在末尾时跟随新数据
+    m_times.resize(m_data->size());
+    qint64 last = from > 0 ? m_times[from - 1] : std::numeric_limits<qint64>::min();
+    for (int i = from; i < m_data->size(); ++i) {
+        last = std::max(last, m_data->at(i).timestamp.toMSecsSinceEpoch());
+        m_times[i] = last;
+    }
+
+    // 只有覆盖新射线的列需要重算
+    if (m_colMs > 0 && from > 0) {
+        const qint64 firstDirty = m_times[from] / m_colMs;
+        for (auto it = m_columns.begin(); it != m_columns.end();) {
+            if (it.key() >= firstDirty) it = m_columns.erase(it);
+            else ++it;
+        }
+    }
+    if (following) {
+        double shift = m_times.last() / 1000.0 + 1.0 - x.upper;
+        m_plot->xAxis->setRange(x.lower + shift, x.upper + shift);
+    }
+    scheduleUpdate();
+}
+
+void TimeRangeView::refresh() {
+    m_columns.clear();
+    scheduleUpdate();
+}
+
+void TimeRangeView::setRayMask(const QVector<bool> *mask) {
+    m_rayMask = mask;
+    refresh();
+}
+
+void TimeRangeView::setColorMap(DisplayMode mode, const ColorMap &colors) {
+    m_colors[mode == Mode_Turbulence ? 1 : 0] = colors;
+    applyGradient();
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+void TimeRangeView::setField(int field) {
+    m_field = Field(field);
+    applyGradient();
+    refresh();
+}
+
+void TimeRangeView::setAggregate(int aggregate) {
+    m_agg = Aggregate(aggregate);
+    refresh();
+}
+
+void TimeRangeView::resizeEvent(QResizeEvent *event) {
+    QWidget::resizeEvent(event);
+    scheduleUpdate(); // 像素列数变了，可能换档
+}
+
+// 风速/湍流沿用 PPI 的色标与值域；SNR 用 Jet，值域随数据
+void TimeRangeView::applyGradient() {
+    QCPColorGradient gradient;
+    if (m_field == Field_Snr) {
+        gradient = QCPColorGradient(QCPColorGradient::gpJet);
+        m_colorScale->axis()->setLabel("SNR (dB)");
+    } else {
+        const ColorMap &cm = m_colors[m_field == Field_Turbulence ? 1 : 0];
+        gradient.clearColorStops();
+        const QVector<QRgb> &table = cm.table();
+        const int stops = 16;
+        for (int i = 0; i <= stops; ++i)
+            gradient.setColorStopAt(double(i) / stops, QColor(qRgb(qRed(table[i * (table.size() - 1) / stops]),
+                                                                   qGreen(table[i * (table.size() - 1) / stops]),
+                                                                   qBlue(table[i * (table.size() - 1) / stops]))));
+        m_map->setDataRange(QCPRange(cm.lo(), cm.hi()));
+        m_colorScale->axis()->setLabel(m_field == Field_Turbulence ? "湍流强度" : "风速 (m/s)");
+    }
+    gradient.setNanHandling(QCPColorGradient::nhTransparent);
+    m_map->setGradient(gradient);
+}
+
+// 列宽档位：不小于每像素的时长，取 1-2-5 序列（10 min 以上对齐金字塔桶）
+qint64 TimeRangeView::chooseColumnMs(double msPerPixel) const {
+    static const qint64 steps[] = { 1000, 2000, 5000, 10000, 30000, 60000, 120000, 300000,
+                                    600000, 1200000, 1800000, 3600000, 2 * 3600000, 6 * 3600000,
+                                    12 * 3600000, 24 * 3600000 };
+    for (qint64 s : steps)
+        if (s >= msPerPixel) return s;
+    const qint64 day = 24 * 3600000;
+    return qint64(std::ceil(msPerPixel / day)) * day;
+}
+
+// 能整除列宽的最粗金字塔层；没有则返回 0（走原始射线）
+int TimeRangeView::pyramidLevelFor(qint64 colMs) const {
+    if (!m_pyramid) return 0;
+    // SNR 只存了均值，取最大值时必须看原始射线
+    if (m_agg == Agg_Max && m_field == Field_Snr) return 0;
+    for (int l = m_pyramid->levelCount() - 1; l >= 1; --l) {
+        qint64 bucketMs = m_pyramid->bucketSeconds(l) * 1000;
+        if (bucketMs > 0 && colMs % bucketMs == 0 && !m_pyramid->buckets(l).isEmpty()) return l;
+    }
+    return 0;
+}
+
+void TimeRangeView::buildColumn(qint64 col, QVector<float> &out) const {
+    const int gates = m_distances.size();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const qint64 t0 = col * m_colMs, t1 = t0 + m_colMs;
+    const int begin = int(std::lower_bound(m_times.constBegin(), m_times.constEnd(), t0) - m_times.constBegin());
+    const int end = int(std::lower_bound(m_times.constBegin(), m_times.constEnd(), t1) - m_times.constBegin());
+
+    QVector<float> acc(gates, m_agg == Agg_Max ? -std::numeric_limits<float>::max() : 0.0f);
+    QVector<int> count(gates, 0);
+    const bool masked = m_rayMask && m_rayMask->size() == m_data->size();
+    for (int i = begin; i < end; ++i) {
+        if (masked && !m_rayMask->at(i)) continue;
+        const QVector<RangeGate> &gs = m_data->at(i).gates;
+        const int n = std::min(gates, int(gs.size()));
+        for (int j = 0; j < n; ++j) {
+            const RangeGate &g = gs[j];
+            if (!g.isValid) continue;
+            float v = m_field == Field_Speed ? g.speed : (m_field == Field_Snr ? g.snr : g.turbulence);
+            if (m_agg == Agg_Max) acc[j] = std::max(acc[j], v);
+            else acc[j] += v;
+            count[j]++;
+        }
+    }
+    out.resize(gates);
+    for (int j = 0; j < gates; ++j)
+        out[j] = count[j] == 0 ? nan : (m_agg == Agg_Max ? acc[j] : acc[j] / count[j]);
+}
+
+// 合并列内的金字塔桶：所有方位分箱一起统计
+void TimeRangeView::buildColumnFromPyramid(int level, qint64 col, QVector<float> &out) const {
+    const int gates = m_distances.size();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const qint64 t0 = col * m_colMs, t1 = t0 + m_colMs;
+    const QVector<PyramidBucket> &bs = m_pyramid->buckets(level);
+    auto it = std::lower_bound(bs.begin(), bs.end(), t0, [](const PyramidBucket &b, qint64 t) { return b.t0Ms < t; });
+
+    QVector<double> acc(gates, m_agg == Agg_Max ? -std::numeric_limits<double>::max() : 0.0);
+    QVector<quint32> count(gates, 0);
+    for (; it != bs.end() && it->t0Ms < t1; ++it) {
+        const int slots = gates > 0 ? int(it->cells.size()) / gates : 0;
+        for (int s = 0; s < slots; ++s) {
+            const PyramidCell *cells = it->cells.constData() + s * gates;
+            for (int j = 0; j < gates; ++j) {
+                const PyramidCell &c = cells[j];
+                if (c.count == 0) continue;
+                if (m_agg == Agg_Max) acc[j] = std::max(acc[j], double(m_field == Field_Speed ? c.maxSpeed() : c.maxTurb()));
+                else acc[j] += double(m_field == Field_Speed ? c.meanSpeed() : (m_field == Field_Snr ? c.meanSnr() : c.meanTurb())) * c.count;
+                count[j] += c.count;
+            }
+        }
+    }
+    out.resize(gates);
+    for (int j = 0; j < gates; ++j)
+        out[j] = count[j] == 0 ? nan : float(m_agg == Agg_Max ? acc[j] : acc[j] / count[j]);
+}
+
+void TimeRangeView::updateColumns() {
+    m_lastBuilt = 0;
+    if (m_times.isEmpty() || m_distances.size() < 2) return;
+
+    const QCPRange x = m_plot->xAxis->range();
+    const int pixels = std::max(1, m_plot->axisRect()->width());
+    const qint64 colMs = chooseColumnMs(x.size() * 1000.0 / pixels);
+    if (colMs != m_colMs) { // 换档：旧列全部作废
+        m_columns.clear();
+        m_colMs = colMs;
+    }
+
+    // 可见列，限制在数据时间范围内
+    qint64 c0 = std::max(qint64(std::floor(x.lower * 1000.0 / colMs)), m_times.first() / colMs);
+    qint64 c1 = std::min(qint64(std::floor(x.upper * 1000.0 / colMs)), m_times.last() / colMs);
+    if (c1 < c0) {
+        m_map->data()->clear();
+        m_plot->replot(QCustomPlot::rpQueuedReplot);
+        return;
+    }
+
+    const int level = pyramidLevelFor(colMs);
+    for (qint64 c = c0; c <= c1; ++c) {
+        if (m_columns.contains(c)) continue;
+        QVector<float> &col = m_columns[c];
+        if (level > 0) buildColumnFromPyramid(level, c, col);
+        else buildColumn(c, col);
+        m_lastBuilt++;
+    }
+    // 缓存只保留可见范围附近的列，平移回来时多数仍可命中
+    const qint64 span = c1 - c0 + 1;
+    if (m_columns.size() > 4 * span) {
+        for (auto it = m_columns.begin(); it != m_columns.end();) {
+            if (it.key() < c0 - span || it.key() > c1 + span) it = m_columns.erase(it);
+            else ++it;
+        }
+    }
+
+    const int keys = int(span), gates = m_distances.size();
+    QCPColorMapData *d = m_map->data();
+    d->setSize(keys, gates);
+    d->setRange(QCPRange((c0 + 0.5) * colMs / 1000.0, (c1 + 0.5) * colMs / 1000.0),
+                QCPRange(m_distances.first(), m_distances.last()));
+    for (int k = 0; k < keys; ++k) {
+        const QVector<float> &col = m_columns[c0 + k];
+        for (int j = 0; j < gates; ++j) d->setCell(k, j, col[j]);
+    }
+    if (m_field == Field_Snr) m_map->rescaleDataRange(true);
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
@@ -0,0 +1,76 @@
+#ifndef TIMERANGEVIEW_H
+#define TIMERANGEVIEW_H
+
+#include <QWidget>
+#include <QHash>
+#include <QTimer>
+#include "datatypes.h"
+#include "colormap.h"
+#include "timepyramid.h"
+#include "qcustomplot.h"
+
+class QComboBox;
+
+// 时间-距离热力图（整段数据的风速/SNR/湍流随时间变化），基于 QCPColorMap：
+//  - 每个像素列对应一个时间列，列宽按缩放档位取整 (1 s ~ 数天)，列边界对齐到绝对时间，
+//    平移时已算好的列直接复用，只补算新露出的列
+//  - 列宽不小于金字塔桶 (10 min/1 h/6 h/1 d) 时直接合并金字塔桶，不再遍历原始射线
+//  - 列内每个距离门取均值或最大值
+//  - 实时接入：数据只在末尾增长时调用 appendData()，只作废最后几列
+class TimeRangeView : public QWidget
+{
+    Q_OBJECT
+public:
+    enum Field { Field_Speed, Field_Snr, Field_Turbulence };
+    enum Aggregate { Agg_Mean, Agg_Max };
+
+    explicit TimeRangeView(QWidget *parent = nullptr);
+
+    void setData(const ScanData* data, const TimePyramid* pyramid);
+    void setRayMask(const QVector<bool>* mask); // 只统计为 true 的射线，与金字塔保持一致；空指针不限制
+    void appendData(); // 数据末尾新增了射线
+    void refresh();    // 处理参数变化，全部列作废
+    void setColorMap(DisplayMode mode, const ColorMap& colors);
+
+    QCustomPlot* plot() const { return m_plot; }
+    int lastColumnsBuilt() const { return m_lastBuilt; } // 最近一次更新实际计算的列数
+
+public slots:
+    void setField(int field);
+    void setAggregate(int aggregate);
+
+protected:
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    void scheduleUpdate() { m_updateTimer->start(); }
+    void updateColumns();
+    void applyGradient();
+    qint64 chooseColumnMs(double msPerPixel) const;
+    int pyramidLevelFor(qint64 colMs) const;
+    void buildColumn(qint64 col, QVector<float>& out) const;
+    void buildColumnFromPyramid(int level, qint64 col, QVector<float>& out) const;
+
+    QCustomPlot* m_plot;
+    QCPColorMap* m_map;
+    QCPColorScale* m_colorScale;
+    QComboBox* m_fieldBox;
+    QComboBox* m_aggBox;
+    QTimer* m_updateTimer;
+
+    const ScanData* m_data = nullptr;
+    const TimePyramid* m_pyramid = nullptr;
+    const QVector<bool>* m_rayMask = nullptr;
+    QVector<qint64> m_times;    // 射线时间 (ms)，二分查找列内射线
+    QVector<float> m_distances; // 距离门（取第一条射线）
+
+    Field m_field = Field_Speed;
+    Aggregate m_agg = Agg_Mean;
+    ColorMap m_colors[2] = { ColorMap(Mode_Speed), ColorMap(Mode_Turbulence) };
+
+    qint64 m_colMs = 0;                      // 当前档位的列宽
+    QHash<qint64, QVector<float>> m_columns; // 当前档位已算好的列（列号 = 时间 / 列宽），NaN 表示无数据
+    int m_lastBuilt = 0;
+};
+
+#endif // TIMERANGEVIEW_H
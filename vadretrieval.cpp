@@ -0,0 +1,144 @@
+#include "vadretrieval.h"
+#include <QtConcurrent>
+#include <QtMath>
+#include <cmath>
+#include <algorithm>
+
+void VadRetrieval::setParams(const VadParams &params) {
+    m_params = params;
+    m_cache.clear();
+}
+
+// 方位覆盖范围 = 360 - 最大方位间隙
+static double azimuthCoverage(const ScanData &data, const SweepInfo &sweep) {
+    QVector<double> az;
+    az.reserve(sweep.rayCount);
+    for (int i = sweep.firstRay; i < sweep.firstRay + sweep.rayCount; ++i) {
+        double a = std::fmod(data[i].azimuth, 360.0);
+        az << (a < 0 ? a + 360.0 : a);
+    }
+    if (az.size() < 2) return 0.0;
+    std::sort(az.begin(), az.end());
+    double maxGap = 360.0 - az.last() + az.first();
+    for (int i = 1; i < az.size(); ++i) maxGap = std::max(maxGap, az[i] - az[i-1]);
+    return 360.0 - maxGap;
+}
+
+// ---------------------------------------------------------
+// 单个 sweep 的批量最小二乘：外层遍历射线，内层连续遍历距离门累加法方程
+// ---------------------------------------------------------
+WindProfile VadRetrieval::fitSweep(const ScanData &data, const SweepInfo &sweep, const VadParams &params) {
+    WindProfile prof;
+    if (sweep.rayCount <= 0) return prof;
+
+    const RadarRay &first = data[sweep.firstRay];
+    prof.time = first.timestamp;
+    prof.elevation = sweep.elevation;
+
+    int gates = 0;
+    for (int i = sweep.firstRay; i < sweep.firstRay + sweep.rayCount; ++i)
+        gates = std::max(gates, int(data[i].gates.size()));
+
+    // 法方程 A x = b 的 6 个独立元素 + 右端 3 项 + Σw·v² (残差用)，按门连续存放
+    QVector<double> s00(gates, 0.0), s01(gates, 0.0), s02(gates, 0.0);
+    QVector<double> s11(gates, 0.0), s12(gates, 0.0), s22(gates, 0.0);
+    QVector<double> b0(gates, 0.0), b1(gates, 0.0), b2(gates, 0.0), vv(gates, 0.0);
+    QVector<int> nRays(gates, 0);
+    QVector<double> dist(gates, 0.0);
+
+    for (int i = sweep.firstRay; i < sweep.firstRay + sweep.rayCount; ++i) {
+        const RadarRay &ray = data[i];
+        // 每条射线只计算一次 sin/cos，所有距离门共用
+        double azRad = qDegreesToRadians(ray.azimuth);
+        double c = std::cos(azRad), s = std::sin(azRad);
+        double cc = c * c, cs = c * s, ss = s * s;
+
+        const RangeGate *g = ray.gates.constData();
+        for (int j = 0; j < ray.gates.size(); ++j) {
+            dist[j] = g[j].distance;
+            if (!g[j].isValid) continue;
+            double w = std::min(std::pow(10.0, g[j].snr / 10.0), params.maxSnrWeight);
+            double v = g[j].speed;
+            s00[j] += w;      s01[j] += w * c;  s02[j] += w * s;
+            s11[j] += w * cc; s12[j] += w * cs; s22[j] += w * ss;
+            b0[j] += w * v;   b1[j] += w * v * c; b2[j] += w * v * s;
+            vv[j] += w * v * v;
+            nRays[j]++;
+        }
+    }
+
+    bool coverageOk = azimuthCoverage(data, sweep) >= params.minCoverage;
+    double elRad = qDegreesToRadians(sweep.elevation);
+    double cosEl = std::cos(elRad), sinEl = std::sin(elRad);
+
+    prof.distance = dist;
+    prof.height.resize(gates);
+    prof.speed.fill(0.0, gates);
+    prof.direction.fill(0.0, gates);
+    prof.vertical.fill(0.0, gates);
+    prof.residual.fill(0.0, gates);
+    prof.valid.fill(false, gates);
+
+    for (int j = 0; j < gates; ++j) {
+        prof.height[j] = dist[j] * sinEl;
+        if (!coverageOk || nRays[j] < params.minRays || std::abs(cosEl) < 1e-6) continue;
+
+        // 3x3 对称矩阵克莱姆法则求解
+        double a00 = s00[j], a01 = s01[j], a02 = s02[j];
+        double a11 = s11[j], a12 = s12[j], a22 = s22[j];
+        double c00 = a11 * a22 - a12 * a12;
+        double c01 = a02 * a12 - a01 * a22;
+        double c02 = a01 * a12 - a02 * a11;
+        double det = a00 * c00 + a01 * c01 + a02 * c02;
+        if (std::abs(det) < 1e-9 * a00 * a00 * a00) continue; // 病态（方位分布过于集中）
+
+        double c11 = a00 * a22 - a02 * a02;
+        double c12 = a01 * a02 - a00 * a12;
+        double c22 = a00 * a11 - a01 * a01;
+        double x0 = (c00 * b0[j] + c01 * b1[j] + c02 * b2[j]) / det;
+        double x1 = (c01 * b0[j] + c11 * b1[j] + c12 * b2[j]) / det;
+        double x2 = (c02 * b0[j] + c12 * b1[j] + c22 * b2[j]) / det;
+
+        // 最优解处 Σw(v - f)² = Σw·v² - xᵀb
+        double sse = vv[j] - (x0 * b0[j] + x1 * b1[j] + x2 * b2[j]);
+        double rms = std::sqrt(std::max(0.0, sse) / a00);
+        if (rms > params.maxResidual) continue;
+
+        double u = x2 / cosEl;
+        double v = x1 / cosEl;
+        prof.speed[j] = std::hypot(u, v);
+        double dir = qRadiansToDegrees(std::atan2(-u, -v));
+        prof.direction[j] = (dir < 0) ? dir + 360.0 : dir;
+        prof.vertical[j] = (std::abs(sinEl) > 0.02) ? x0 / sinEl : 0.0;
+        prof.residual[j] = rms;
+        prof.valid[j] = true;
+    }
+    return prof;
+}
+
+// ---------------------------------------------------------
+// 批量反演：只计算缓存中没有的 sweep，多个 sweep 并行
+// ---------------------------------------------------------
+QVector<WindProfile> VadRetrieval::retrieve(const ScanData &data, const SweepList &sweeps) {
+    QVector<int> todo;
+    for (int i = 0; i < sweeps.size(); ++i) {
+        if (!m_cache.contains(sweepKey(sweeps[i]))) todo << i;
+    }
+
+    if (!todo.isEmpty()) {
+        const VadParams params = m_params;
+        QList<WindProfile> fitted = QtConcurrent::blockingMapped<QList<WindProfile>>(todo, [&](int idx) {
+            return fitSweep(data, sweeps[idx], params);
+        });
+        for (int k = 0; k < todo.size(); ++k) m_cache.insert(sweepKey(sweeps[todo[k]]), fitted[k]);
+    }
+
+    QVector<WindProfile> out;
+    out.reserve(sweeps.size());
+    for (int i = 0; i < sweeps.size(); ++i) {
+        WindProfile p = m_cache.value(sweepKey(sweeps[i]));
+        p.sweepIndex = i;
+        out << p;
+    }
+    return out;
+}
@@ -0,0 +1,53 @@
+#ifndef VADRETRIEVAL_H
+#define VADRETRIEVAL_H
+
+#include "datatypes.h"
+#include <QHash>
+
+// 单个 sweep 反演得到的风廓线（按距离门排列）
+struct WindProfile {
+    int sweepIndex = -1;
+    QDateTime time;            // sweep 起始时间
+    double elevation = 0.0;
+    QVector<double> distance;  // 斜距 (m)
+    QVector<double> height;    // 高度 (m)
+    QVector<double> speed;     // 水平风速 (m/s)
+    QVector<double> direction; // 风向 (来向, 0=北, 顺时针, 度)
+    QVector<double> vertical;  // 垂直速度 (m/s)，仰角过低时为 0
+    QVector<double> residual;  // 加权拟合残差 RMS (m/s)
+    QVector<bool> valid;
+};
+
+struct VadParams {
+    int minRays = 8;              // 每个距离门至少参与拟合的有效射线数
+    double minCoverage = 180.0;   // sweep 方位覆盖范围下限 (度)
+    double maxResidual = 3.0;     // 残差超过此值视为拟合失败 (m/s)
+    double maxSnrWeight = 100.0;  // 线性 SNR 权重上限，防止个别强回波主导拟合
+};
+
+// VAD (Velocity-Azimuth Display) 正弦拟合：
+//   Vr(az) = a0 + a1*cos(az) + a2*sin(az)
+//   u = a2/cos(el), v = a1/cos(el), w = a0/sin(el)
+// 同一 sweep 的所有距离门共享 sin/cos(az)，按门批量累加 3x3 加权法方程后逐门求解。
+class VadRetrieval
+{
+public:
+    void setParams(const VadParams& params);
+    const VadParams& params() const { return m_params; }
+
+    // 处理后数据发生变化（过滤阈值等）时调用，丢弃全部结果
+    void invalidate() { m_cache.clear(); }
+
+    // 对全部 sweep 反演：已有结果的 sweep 直接复用，新到/变长的 sweep 在线程池中并行计算
+    QVector<WindProfile> retrieve(const ScanData& data, const SweepList& sweeps);
+
+    static WindProfile fitSweep(const ScanData& data, const SweepInfo& sweep, const VadParams& params);
+
+private:
+    static qint64 sweepKey(const SweepInfo& s) { return (qint64(s.firstRay) << 32) | quint32(s.rayCount); }
+
+    VadParams m_params;
+    QHash<qint64, WindProfile> m_cache;
+};
+
+#endif // VADRETRIEVAL_H